@@ -0,0 +1,854 @@
+#ifndef ART_H
+#define ART_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "array_exception.h"
+
+/**
+ * \brief Адаптивное префиксное дерево (Adaptive Radix Tree) со строковыми (двоичными) ключами.
+ *
+ * Внутренние узлы ветвятся по одному байту ключа и меняют представление по мере роста
+ * числа потомков: 4, 16, 48 и 256 ссылок. Общие части ключей хранятся в узлах
+ * как сжатый путь (префикс), а лист подвешивается, как только его ключ становится
+ * единственным в поддереве; лист хранит только оставшийся хвост ключа.
+ * Поэтому поиск стоит O(длины ключа) независимо от числа ключей.
+ * Порядок обхода совпадает с порядком std::string.
+*/
+template<typename Data>
+class ART {
+private:
+    // Лист хранит только часть ключа после места, где он подвешен: начало ключа
+    // однозначно задаётся путём от корня (префиксами узлов и байтами ветвления).
+    struct Leaf {
+        std::string suffix;
+        Data data;
+
+        Leaf(std::string s, const Data& d) : suffix(std::move(s)), data(d) {}
+    };
+
+    enum class Node_type : uint8_t { node4, node16, node48, node256 };
+
+    struct Inner {
+        Node_type type;
+        uint16_t count;     // число потомков
+        std::string prefix; // сжатый путь: байты ключа, общие для всего поддерева
+        Leaf* value;        // ключ, заканчивающийся сразу после префикса
+
+        explicit Inner(Node_type t) : type(t), count(0), value(nullptr) {}
+    };
+
+    // Ссылка на потомка: адрес внутреннего узла или адрес листа с установленным младшим битом.
+    using Child = uintptr_t;
+
+    struct Node4 : Inner {
+        uint8_t keys[4];
+        Child children[4] = {};
+
+        Node4() : Inner(Node_type::node4) {}
+    };
+
+    struct Node16 : Inner {
+        uint8_t keys[16];
+        Child children[16] = {};
+
+        Node16() : Inner(Node_type::node16) {}
+    };
+
+    struct Node48 : Inner {
+        uint8_t index[256] = {}; // 0 - нет потомка, иначе номер ячейки в children + 1
+        Child children[48] = {};
+
+        Node48() : Inner(Node_type::node48) {}
+    };
+
+    struct Node256 : Inner {
+        Child children[256] = {};
+
+        Node256() : Inner(Node_type::node256) {}
+    };
+
+    Child root;
+    size_t size;
+
+    static bool is_leaf(Child child) { return (child & 1) != 0; }
+    static Leaf* as_leaf(Child child) { return reinterpret_cast<Leaf*>(child & ~static_cast<Child>(1)); }
+    static Inner* as_inner(Child child) { return reinterpret_cast<Inner*>(child); }
+    static Child from_leaf(Leaf* leaf) { return reinterpret_cast<Child>(leaf) | 1; }
+    static Child from_inner(Inner* node) { return reinterpret_cast<Child>(node); }
+
+    static void free_inner(Inner* node);
+
+    static Child* find_child(Inner* node, uint8_t byte);
+
+    // Следующий потомок в порядке возрастания байта; cursor - позиция обхода внутри узла.
+    static Child next_child(Inner* node, int& cursor, uint8_t& byte);
+
+    // Перенос общих полей при смене типа узла.
+    static void move_header(Inner* to, Inner* from);
+
+    // Добавление потомка; ref - ссылка на узел node у его родителя (узел может вырасти:
+    // больший узел заполняется и подвешивается по ref до освобождения старого).
+    static void add_child(Child& ref, Inner* node, uint8_t byte, Child child);
+
+    static void remove_child(Inner* node, uint8_t byte);
+
+    // Приведение узла в порядок после удаления: сжатие пути и уменьшение типа.
+    static void shrink(Child& ref);
+
+    Leaf* find_leaf(const std::string& key) const;
+
+public:
+    /**
+     * \brief Конструктор по умолчанию.
+     * \post Дерево пустое.
+    */
+    ART() : root(0), size(0) {}
+
+    ART(const ART& other) = delete;
+    ART& operator=(const ART& other) = delete;
+
+    /**
+     * \brief Деструктор.
+     * \post Дерево освобождено.
+    */
+    ~ART() {
+        clear();
+    }
+
+    /**
+     * \brief Получение размера дерева.
+     * \post Дерево остаётся неизменным.
+    */
+    size_t get_size() const { return size; }
+
+    /**
+     * \brief Проверка дерева на пустоту.
+     * \post Дерево остаётся неизменным.
+    */
+    bool is_empty() const { return size == 0; }
+
+    /**
+     * \brief Очистка дерева.
+     * \post Дерево пустое.
+    */
+    void clear();
+
+    /**
+     * \brief Поиск элемента с заданным ключом.
+     * \param key Ключ для поиска.
+     * \return Ссылка на найденный элемент.
+     * \throw Array_exception если элемент с заданным ключом не существует в дереве.
+    */
+    Data& operator[](const std::string& key);
+
+    /**
+     * \brief Поиск элемента с заданным ключом (константная версия).
+     * \throw Array_exception если элемент с заданным ключом не существует в дереве.
+    */
+    const Data& operator[](const std::string& key) const;
+
+    /**
+     * \brief Поиск элемента с заданным ключом.
+     * \throw Array_exception если элемент с заданным ключом не существует в дереве.
+    */
+    Data& at(const std::string& key) { return (*this)[key]; }
+
+    /**
+     * \brief Поиск элемента с заданным ключом (константная версия).
+     * \throw Array_exception если элемент с заданным ключом не существует в дереве.
+    */
+    const Data& at(const std::string& key) const { return (*this)[key]; }
+
+    /**
+     * \brief Проверка наличия ключа.
+     * \post Дерево остаётся неизменным.
+    */
+    bool contains(const std::string& key) const { return find_leaf(key) != nullptr; }
+
+    /**
+     * \brief Вставляет данные с заданным ключом в дерево.
+     * \param key Ключ для вставки.
+     * \param data Данные для вставки.
+     * \return true, если элемент был вставлен, иначе false (ключ уже есть).
+    */
+    bool insert(const std::string& key, const Data& data);
+
+    /**
+     * \brief Удаляет элемент с заданным ключом из дерева.
+     * \param key Ключ для удаления.
+     * \return true, если элемент был удалён, иначе false.
+    */
+    bool remove(const std::string& key);
+
+    /**
+     * \brief Формирование списка ключей в порядке возрастания.
+     * \post Дерево остаётся неизменным.
+    */
+    std::vector<std::string> get_keys() const;
+
+    /**
+     * \brief Прямой итератор по элементам в порядке возрастания ключей.
+    */
+    class Iterator {
+    private:
+        struct Frame {
+            Inner* node;
+            int cursor;
+            size_t key_length; // длина ключа до конца префикса узла
+        };
+
+        std::vector<Frame> path;
+        std::string current_key; // ключ восстанавливается по пути от корня
+        Leaf* current;
+
+        void advance() {
+            while (!path.empty()) {
+                Frame& frame = path.back();
+                uint8_t byte = 0;
+                Child child = next_child(frame.node, frame.cursor, byte);
+
+                if (child == 0) {
+                    path.pop_back();
+                    continue;
+                }
+
+                current_key.resize(frame.key_length);
+                current_key.push_back(static_cast<char>(byte));
+
+                if (is_leaf(child)) {
+                    current = as_leaf(child);
+                    current_key += current->suffix;
+                    return;
+                }
+
+                Inner* node = as_inner(child);
+                current_key += node->prefix;
+                path.push_back(Frame{ node, 0, current_key.size() });
+                if (node->value != nullptr) { // ключ узла меньше ключей его потомков
+                    current = node->value;
+                    return;
+                }
+            }
+
+            current = nullptr;
+        }
+
+    public:
+        Iterator() : current(nullptr) {}
+
+        explicit Iterator(Child root) : current(nullptr) {
+            if (root == 0) {
+                return;
+            }
+
+            if (is_leaf(root)) {
+                current = as_leaf(root);
+                current_key = current->suffix;
+                return;
+            }
+
+            Inner* node = as_inner(root);
+            current_key = node->prefix;
+            path.push_back(Frame{ node, 0, current_key.size() });
+            if (node->value != nullptr) {
+                current = node->value;
+            } else {
+                advance();
+            }
+        }
+
+        Data& operator*() const {
+            if (current == nullptr) {
+                throw Array_exception("Iterator is not initialized");
+            }
+            return current->data;
+        }
+
+        const std::string& key() const {
+            if (current == nullptr) {
+                throw Array_exception("Iterator is not initialized");
+            }
+            return current_key;
+        }
+
+        /**
+         * \brief Переход к следующему элементу в дереве.
+        */
+        Iterator& operator++() {
+            if (current == nullptr) {
+                throw Array_exception("Cannot move past end of the tree");
+            }
+            advance();
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const { return current == other.current; }
+
+        bool operator!=(const Iterator& other) const { return current != other.current; }
+    };
+
+    Iterator begin() const { return Iterator(root); }
+
+    Iterator end() const { return Iterator(); }
+};
+
+template <typename Data>
+void ART<Data>::free_inner(Inner* node) {
+    switch (node->type) {
+    case Node_type::node4:
+        delete static_cast<Node4*>(node);
+        break;
+    case Node_type::node16:
+        delete static_cast<Node16*>(node);
+        break;
+    case Node_type::node48:
+        delete static_cast<Node48*>(node);
+        break;
+    case Node_type::node256:
+        delete static_cast<Node256*>(node);
+        break;
+    }
+}
+
+template <typename Data>
+typename ART<Data>::Child* ART<Data>::find_child(Inner* node, uint8_t byte) {
+    switch (node->type) {
+    case Node_type::node4: {
+        Node4* n = static_cast<Node4*>(node);
+        for (uint16_t i = 0; i < n->count; ++i) {
+            if (n->keys[i] == byte) {
+                return &n->children[i];
+            }
+        }
+        return nullptr;
+    }
+    case Node_type::node16: {
+        Node16* n = static_cast<Node16*>(node);
+        for (uint16_t i = 0; i < n->count; ++i) { // ключи упорядочены
+            if (n->keys[i] >= byte) {
+                return n->keys[i] == byte ? &n->children[i] : nullptr;
+            }
+        }
+        return nullptr;
+    }
+    case Node_type::node48: {
+        Node48* n = static_cast<Node48*>(node);
+        return n->index[byte] == 0 ? nullptr : &n->children[n->index[byte] - 1];
+    }
+    default: {
+        Node256* n = static_cast<Node256*>(node);
+        return n->children[byte] == 0 ? nullptr : &n->children[byte];
+    }
+    }
+}
+
+template <typename Data>
+typename ART<Data>::Child ART<Data>::next_child(Inner* node, int& cursor, uint8_t& byte) {
+    switch (node->type) {
+    case Node_type::node4: {
+        Node4* n = static_cast<Node4*>(node);
+        if (cursor >= n->count) {
+            return 0;
+        }
+        byte = n->keys[cursor];
+        return n->children[cursor++];
+    }
+    case Node_type::node16: {
+        Node16* n = static_cast<Node16*>(node);
+        if (cursor >= n->count) {
+            return 0;
+        }
+        byte = n->keys[cursor];
+        return n->children[cursor++];
+    }
+    case Node_type::node48: {
+        Node48* n = static_cast<Node48*>(node);
+        while (cursor < 256) {
+            int b = cursor++;
+            if (n->index[b] != 0) {
+                byte = static_cast<uint8_t>(b);
+                return n->children[n->index[b] - 1];
+            }
+        }
+        return 0;
+    }
+    default: {
+        Node256* n = static_cast<Node256*>(node);
+        while (cursor < 256) {
+            int b = cursor++;
+            if (n->children[b] != 0) {
+                byte = static_cast<uint8_t>(b);
+                return n->children[b];
+            }
+        }
+        return 0;
+    }
+    }
+}
+
+template <typename Data>
+void ART<Data>::move_header(Inner* to, Inner* from) {
+    to->count = from->count;
+    to->prefix = std::move(from->prefix);
+    to->value = from->value;
+}
+
+template <typename Data>
+void ART<Data>::add_child(Child& ref, Inner* node, uint8_t byte, Child child) {
+    switch (node->type) {
+    case Node_type::node4: {
+        Node4* n = static_cast<Node4*>(node);
+        if (n->count < 4) {
+            uint16_t i = n->count;
+            for (; i > 0 && n->keys[i - 1] > byte; --i) { // сохраняем порядок ключей
+                n->keys[i] = n->keys[i - 1];
+                n->children[i] = n->children[i - 1];
+            }
+            n->keys[i] = byte;
+            n->children[i] = child;
+            ++n->count;
+            return;
+        }
+
+        Node16* bigger = new Node16();
+        move_header(bigger, n);
+        for (uint16_t i = 0; i < 4; ++i) {
+            bigger->keys[i] = n->keys[i];
+            bigger->children[i] = n->children[i];
+        }
+        add_child(ref, bigger, byte, child); // в новом узле есть место: он не растёт
+        ref = from_inner(bigger);
+        delete n;
+        return;
+    }
+    case Node_type::node16: {
+        Node16* n = static_cast<Node16*>(node);
+        if (n->count < 16) {
+            uint16_t i = n->count;
+            for (; i > 0 && n->keys[i - 1] > byte; --i) {
+                n->keys[i] = n->keys[i - 1];
+                n->children[i] = n->children[i - 1];
+            }
+            n->keys[i] = byte;
+            n->children[i] = child;
+            ++n->count;
+            return;
+        }
+
+        Node48* bigger = new Node48();
+        move_header(bigger, n);
+        for (uint16_t i = 0; i < 16; ++i) {
+            bigger->index[n->keys[i]] = static_cast<uint8_t>(i + 1);
+            bigger->children[i] = n->children[i];
+        }
+        add_child(ref, bigger, byte, child); // в новом узле есть место: он не растёт
+        ref = from_inner(bigger);
+        delete n;
+        return;
+    }
+    case Node_type::node48: {
+        Node48* n = static_cast<Node48*>(node);
+        if (n->count < 48) {
+            int slot = 0;
+            while (n->children[slot] != 0) { // после удалений ячейки освобождаются не по порядку
+                ++slot;
+            }
+            n->children[slot] = child;
+            n->index[byte] = static_cast<uint8_t>(slot + 1);
+            ++n->count;
+            return;
+        }
+
+        Node256* bigger = new Node256();
+        move_header(bigger, n);
+        for (int b = 0; b < 256; ++b) {
+            if (n->index[b] != 0) {
+                bigger->children[b] = n->children[n->index[b] - 1];
+            }
+        }
+        add_child(ref, bigger, byte, child); // в новом узле есть место: он не растёт
+        ref = from_inner(bigger);
+        delete n;
+        return;
+    }
+    default: {
+        Node256* n = static_cast<Node256*>(node);
+        n->children[byte] = child;
+        ++n->count;
+    }
+    }
+}
+
+template <typename Data>
+void ART<Data>::remove_child(Inner* node, uint8_t byte) {
+    switch (node->type) {
+    case Node_type::node4:
+    case Node_type::node16: {
+        uint8_t* keys = node->type == Node_type::node4 ? static_cast<Node4*>(node)->keys : static_cast<Node16*>(node)->keys;
+        Child* children = node->type == Node_type::node4 ? static_cast<Node4*>(node)->children
+                                                         : static_cast<Node16*>(node)->children;
+        uint16_t i = 0;
+        while (keys[i] != byte) {
+            ++i;
+        }
+        for (; i + 1 < node->count; ++i) {
+            keys[i] = keys[i + 1];
+            children[i] = children[i + 1];
+        }
+        children[node->count - 1] = 0;
+        --node->count;
+        return;
+    }
+    case Node_type::node48: {
+        Node48* n = static_cast<Node48*>(node);
+        n->children[n->index[byte] - 1] = 0;
+        n->index[byte] = 0;
+        --n->count;
+        return;
+    }
+    default: {
+        Node256* n = static_cast<Node256*>(node);
+        n->children[byte] = 0;
+        --n->count;
+    }
+    }
+}
+
+template <typename Data>
+void ART<Data>::shrink(Child& ref) {
+    Inner* node = as_inner(ref);
+
+    if (node->count == 0) { // остался только ключ самого узла (или ничего)
+        if (node->value == nullptr) {
+            ref = 0;
+        } else { // лист поднимается на место узла и забирает его префикс
+            node->value->suffix = std::move(node->prefix);
+            ref = from_leaf(node->value);
+        }
+        free_inner(node);
+        return;
+    }
+
+    if (node->count == 1 && node->value == nullptr) { // узел с одним потомком сливается с ним
+        int cursor = 0;
+        uint8_t byte = 0;
+        Child only = next_child(node, cursor, byte);
+        std::string& tail = is_leaf(only) ? as_leaf(only)->suffix : as_inner(only)->prefix;
+        tail = node->prefix + static_cast<char>(byte) + tail;
+
+        ref = only;
+        free_inner(node);
+        return;
+    }
+
+    // уменьшение типа узла с запасом, чтобы не менять тип туда и обратно на каждой операции
+    if (node->type == Node_type::node16 && node->count <= 3) {
+        Node16* n = static_cast<Node16*>(node);
+        Node4* smaller = new Node4();
+        move_header(smaller, n);
+        for (uint16_t i = 0; i < n->count; ++i) {
+            smaller->keys[i] = n->keys[i];
+            smaller->children[i] = n->children[i];
+        }
+        delete n;
+        ref = from_inner(smaller);
+    } else if (node->type == Node_type::node48 && node->count <= 12) {
+        Node48* n = static_cast<Node48*>(node);
+        Node16* smaller = new Node16();
+        move_header(smaller, n);
+        uint16_t i = 0;
+        for (int b = 0; b < 256; ++b) {
+            if (n->index[b] != 0) {
+                smaller->keys[i] = static_cast<uint8_t>(b);
+                smaller->children[i] = n->children[n->index[b] - 1];
+                ++i;
+            }
+        }
+        delete n;
+        ref = from_inner(smaller);
+    } else if (node->type == Node_type::node256 && node->count <= 40) {
+        Node256* n = static_cast<Node256*>(node);
+        Node48* smaller = new Node48();
+        move_header(smaller, n);
+        int slot = 0;
+        for (int b = 0; b < 256; ++b) {
+            if (n->children[b] != 0) {
+                smaller->children[slot] = n->children[b];
+                smaller->index[b] = static_cast<uint8_t>(slot + 1);
+                ++slot;
+            }
+        }
+        delete n;
+        ref = from_inner(smaller);
+    }
+}
+
+template <typename Data>
+typename ART<Data>::Leaf* ART<Data>::find_leaf(const std::string& key) const {
+    Child current = root;
+    size_t depth = 0;
+
+    while (current != 0) {
+        if (is_leaf(current)) { // остаток ключа сравнивается с хвостом листа
+            Leaf* leaf = as_leaf(current);
+            return key.compare(depth, std::string::npos, leaf->suffix) == 0 ? leaf : nullptr;
+        }
+
+        Inner* node = as_inner(current);
+        const std::string& prefix = node->prefix;
+        if (key.size() - depth < prefix.size() || key.compare(depth, prefix.size(), prefix) != 0) {
+            return nullptr;
+        }
+        depth += prefix.size();
+
+        if (depth == key.size()) {
+            return node->value;
+        }
+
+        Child* next = find_child(node, static_cast<uint8_t>(key[depth]));
+        if (next == nullptr) {
+            return nullptr;
+        }
+        current = *next;
+        ++depth;
+    }
+
+    return nullptr;
+}
+
+template <typename Data>
+Data& ART<Data>::operator[](const std::string& key) {
+    Leaf* leaf = find_leaf(key);
+    if (leaf == nullptr) {
+        throw Array_exception("No such key in ART");
+    }
+    return leaf->data;
+}
+
+template <typename Data>
+const Data& ART<Data>::operator[](const std::string& key) const {
+    Leaf* leaf = find_leaf(key);
+    if (leaf == nullptr) {
+        throw Array_exception("No such key in ART");
+    }
+    return leaf->data;
+}
+
+template <typename Data>
+bool ART<Data>::insert(const std::string& key, const Data& data) {
+    Child* ref = &root;
+    size_t depth = 0;
+
+    while (true) {
+        Child current = *ref;
+
+        if (current == 0) { // свободное место
+            *ref = from_leaf(new Leaf(key.substr(depth), data));
+            ++size;
+            return true;
+        }
+
+        if (is_leaf(current)) { // лист расщепляется по общей части двух ключей
+            Leaf* leaf = as_leaf(current);
+            std::string& suffix = leaf->suffix;
+            if (key.compare(depth, std::string::npos, suffix) == 0) { // дубликаты запрещены
+                return false;
+            }
+
+            size_t common = 0;
+            while (common < suffix.size() && depth + common < key.size() && suffix[common] == key[depth + common]) {
+                ++common;
+            }
+
+            // сначала выделяется всё новое: при исключении старый лист остаётся нетронутым
+            size_t split = depth + common;
+            std::unique_ptr<Node4> node(new Node4());
+            node->prefix = suffix.substr(0, common);
+            std::unique_ptr<Leaf> added(new Leaf(key.size() == split ? std::string() : key.substr(split + 1), data));
+            Child node_ref = from_inner(node.get());
+
+            // дальше только перевязка: в Node4 не больше двух потомков, и он не растёт
+            if (suffix.size() == common) {
+                suffix.clear();
+                node->value = leaf;
+            } else {
+                uint8_t byte = static_cast<uint8_t>(suffix[common]);
+                suffix.erase(0, common + 1);
+                add_child(node_ref, node.get(), byte, current);
+            }
+
+            if (key.size() == split) {
+                node->value = added.release();
+            } else {
+                add_child(node_ref, node.get(), static_cast<uint8_t>(key[split]), from_leaf(added.release()));
+            }
+
+            *ref = from_inner(node.release());
+            ++size;
+            return true;
+        }
+
+        Inner* node = as_inner(current);
+        const std::string& prefix = node->prefix;
+
+        size_t matched = 0;
+        while (matched < prefix.size() && depth + matched < key.size() && prefix[matched] == key[depth + matched]) {
+            ++matched;
+        }
+
+        if (matched < prefix.size()) { // ключ расходится со сжатым путём: путь разрезается
+            // сначала выделяется всё новое: при исключении путь узла остаётся нетронутым
+            depth += matched;
+            std::unique_ptr<Node4> parent(new Node4());
+            parent->prefix = prefix.substr(0, matched);
+            std::unique_ptr<Leaf> added(new Leaf(depth == key.size() ? std::string() : key.substr(depth + 1), data));
+            Child parent_ref = from_inner(parent.get());
+
+            uint8_t branch = static_cast<uint8_t>(prefix[matched]);
+            node->prefix.erase(0, matched + 1);
+            add_child(parent_ref, parent.get(), branch, current);
+
+            if (depth == key.size()) {
+                parent->value = added.release();
+            } else {
+                add_child(parent_ref, parent.get(), static_cast<uint8_t>(key[depth]), from_leaf(added.release()));
+            }
+
+            *ref = from_inner(parent.release());
+            ++size;
+            return true;
+        }
+
+        depth += prefix.size();
+
+        if (depth == key.size()) { // ключ заканчивается в этом узле
+            if (node->value != nullptr) {
+                return false;
+            }
+            node->value = new Leaf(std::string(), data);
+            ++size;
+            return true;
+        }
+
+        Child* next = find_child(node, static_cast<uint8_t>(key[depth]));
+        if (next == nullptr) {
+            // если узел не сможет вырасти, новый лист освободится
+            std::unique_ptr<Leaf> added(new Leaf(key.substr(depth + 1), data));
+            add_child(*ref, node, static_cast<uint8_t>(key[depth]), from_leaf(added.get()));
+            added.release();
+            ++size;
+            return true;
+        }
+
+        ref = next;
+        ++depth;
+    }
+}
+
+template <typename Data>
+bool ART<Data>::remove(const std::string& key) {
+    Child* parent_ref = nullptr; // ссылка на родителя текущего узла
+    uint8_t parent_byte = 0;     // байт, по которому родитель ведёт к текущему узлу
+    Child* ref = &root;
+    size_t depth = 0;
+
+    while (*ref != 0) {
+        Child current = *ref;
+
+        if (is_leaf(current)) {
+            Leaf* leaf = as_leaf(current);
+            if (key.compare(depth, std::string::npos, leaf->suffix) != 0) {
+                return false;
+            }
+
+            delete leaf;
+            --size;
+
+            if (parent_ref == nullptr) {
+                root = 0;
+            } else {
+                remove_child(as_inner(*parent_ref), parent_byte);
+                shrink(*parent_ref);
+            }
+            return true;
+        }
+
+        Inner* node = as_inner(current);
+        const std::string& prefix = node->prefix;
+        if (key.size() - depth < prefix.size() || key.compare(depth, prefix.size(), prefix) != 0) {
+            return false;
+        }
+        depth += prefix.size();
+
+        if (depth == key.size()) {
+            if (node->value == nullptr) {
+                return false;
+            }
+
+            delete node->value;
+            node->value = nullptr;
+            --size;
+            shrink(*ref);
+            return true;
+        }
+
+        Child* next = find_child(node, static_cast<uint8_t>(key[depth]));
+        if (next == nullptr) {
+            return false;
+        }
+
+        parent_ref = ref;
+        parent_byte = static_cast<uint8_t>(key[depth]);
+        ref = next;
+        ++depth;
+    }
+
+    return false;
+}
+
+template <typename Data>
+void ART<Data>::clear() {
+    std::vector<Child> node_stack;
+    if (root != 0) {
+        node_stack.push_back(root);
+    }
+
+    while (!node_stack.empty()) {
+        Child current = node_stack.back();
+        node_stack.pop_back();
+
+        if (is_leaf(current)) {
+            delete as_leaf(current);
+            continue;
+        }
+
+        Inner* node = as_inner(current);
+        int cursor = 0;
+        uint8_t byte = 0;
+        for (Child child = next_child(node, cursor, byte); child != 0; child = next_child(node, cursor, byte)) {
+            node_stack.push_back(child);
+        }
+        delete node->value;
+        free_inner(node);
+    }
+
+    root = 0;
+    size = 0;
+}
+
+template <typename Data>
+std::vector<std::string> ART<Data>::get_keys() const {
+    std::vector<std::string> keys;
+    keys.reserve(size);
+
+    for (Iterator it = begin(); it != end(); ++it) {
+        keys.push_back(it.key());
+    }
+
+    return keys;
+}
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef AUGMENTATION_H
+#define AUGMENTATION_H
+
+#include <algorithm> // for std::min, std::max
+#include <cstdint>
+#include <cstddef>
+#include <functional> // for std::hash
+
+/**
+ * Дополнение (augmentation) дерева - моноид над элементами, агрегат которого хранится
+ * в каждом узле для всего его поддерева. Тип дополнения должен предоставлять:
+ *   value_type                     - тип агрегата;
+ *   static value_type identity()   - нейтральный элемент;
+ *   static value_type lift(key, data) - агрегат одного элемента;
+ *   static value_type combine(a, b)   - ассоциативная операция (a левее b по ключам).
+ * Коммутативность не требуется: агрегат складывается в порядке возрастания ключей.
+*/
+
+/**
+ * \brief Отсутствие дополнения: узлы дерева не хранят агрегатов.
+*/
+struct No_augmentation {
+    struct value_type {};
+};
+
+/**
+ * \brief Сумма данных.
+*/
+template<typename Key, typename Data>
+struct Sum_augmentation {
+    using value_type = Data;
+
+    static value_type identity() { return Data(); }
+    static value_type lift(const Key&, const Data& data) { return data; }
+    static value_type combine(const value_type& a, const value_type& b) { return a + b; }
+};
+
+/**
+ * \brief Минимум и максимум данных. Пустой агрегат имеет count == 0.
+*/
+template<typename Key, typename Data>
+struct Min_max_augmentation {
+    struct value_type {
+        size_t count = 0; // число элементов
+        Data min{};
+        Data max{};
+    };
+
+    static value_type identity() { return value_type(); }
+    static value_type lift(const Key&, const Data& data) { return value_type{ 1, data, data }; }
+
+    static value_type combine(const value_type& a, const value_type& b) {
+        if (a.count == 0) {
+            return b;
+        }
+        if (b.count == 0) {
+            return a;
+        }
+
+        return value_type{ a.count + b.count, std::min(a.min, b.min), std::max(a.max, b.max) };
+    }
+};
+
+/**
+ * \brief Дерево интервалов: ключ - начало отрезка, данные - его конец (включительно).
+ * Агрегат поддерева - наименьшее начало и наибольший конец, по которым
+ * BST::visit_where отсекает поддеревья, не пересекающиеся с запросом.
+*/
+template<typename T>
+struct Interval_augmentation {
+    struct value_type {
+        bool empty = true;
+        T low{};  // наименьшее начало
+        T high{}; // наибольший конец
+    };
+
+    static value_type identity() { return value_type(); }
+    static value_type lift(const T& start, const T& end) { return value_type{ false, start, end }; }
+
+    static value_type combine(const value_type& a, const value_type& b) {
+        if (a.empty) {
+            return b;
+        }
+        if (b.empty) {
+            return a;
+        }
+
+        return value_type{ false, std::min(a.low, b.low), std::max(a.high, b.high) };
+    }
+
+    /**
+     * \brief Предикат для visit_where: может ли агрегат содержать отрезок, пересекающийся с [from, to].
+    */
+    static auto overlapping(const T& from, const T& to) {
+        return [from, to](const value_type& summary) {
+            return !summary.empty && !(to < summary.low) && !(summary.high < from);
+        };
+    }
+};
+
+/**
+ * \brief Хэш последовательности элементов для сравнения деревьев (BST::diff).
+ * Агрегат - полиномиальный хэш по модулю 2^61 - 1 от хэшей элементов в порядке возрастания
+ * ключей. Он зависит только от содержимого поддерева, а не от его формы, поэтому совпадает
+ * у реплик, построенных разным порядком вставок, и у любых диапазонов ключей с равным содержимым.
+*/
+template<typename Key, typename Data>
+struct Hash_augmentation {
+    struct value_type {
+        uint64_t hash = 0;  // сумма h_i * base^(n - 1 - i)
+        uint64_t power = 1; // base^n
+        size_t count = 0;   // число элементов
+
+        bool operator==(const value_type&) const = default;
+    };
+
+    static constexpr uint64_t modulus = (uint64_t(1) << 61) - 1;
+    static constexpr uint64_t base = 0x0123456789abcdefull;
+
+    static uint64_t reduce(uint64_t x) {
+        x = (x & modulus) + (x >> 61);
+        return x >= modulus ? x - modulus : x;
+    }
+
+    static uint64_t multiply(uint64_t a, uint64_t b) {
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        uint64_t x = (static_cast<uint64_t>(product) & modulus) + static_cast<uint64_t>(product >> 61);
+        return x >= modulus ? x - modulus : x;
+    }
+
+    // Финализатор MurmurHash3, как в фильтре Блума.
+    static uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    static value_type identity() { return value_type(); }
+
+    static value_type lift(const Key& key, const Data& data) {
+        uint64_t h = mix(mix(std::hash<Key>()(key)) ^ std::hash<Data>()(data));
+        return value_type{ reduce(h), base, 1 };
+    }
+
+    static value_type combine(const value_type& a, const value_type& b) {
+        return value_type{ reduce(multiply(a.hash, b.power) + b.hash), multiply(a.power, b.power), a.count + b.count };
+    }
+};
+
+#endif
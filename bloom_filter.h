@@ -0,0 +1,140 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cmath> // for std::exp, std::pow
+
+/**
+ * \brief Блочный фильтр Блума: приближённое множество 64-битных хэшей.
+ *
+ * Все биты одного ключа лежат в одном блоке размером с кэш-линию, поэтому
+ * проверка стоит одного обращения к памяти. Ложных отрицательных ответов нет,
+ * ложные положительные возникают с вероятностью около (доля единиц в блоке)^k.
+ * Удаление не поддерживается: после удалений фильтр строится заново.
+*/
+class Blocked_bloom_filter {
+private:
+    static constexpr size_t block_bits = 512;
+    static constexpr int max_probes = 7; // 7 девятибитных номеров из одного 64-битного хэша
+
+    struct alignas(64) Block {
+        uint64_t words[block_bits / 64] = {};
+    };
+
+    std::vector<Block> blocks;
+    int probes = 0;
+    size_t key_count = 0;
+
+    // Финализатор MurmurHash3: перемешивает все биты хэша.
+    static uint64_t mix(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // Номер блока по старшим 32 битам без деления: (h * число блоков) / 2^32.
+    size_t block_index(uint64_t h) const {
+        return static_cast<size_t>(((h >> 32) * blocks.size()) >> 32);
+    }
+
+public:
+    /**
+     * \brief Создание фильтра.
+     * \param capacity Ожидаемое число ключей.
+     * \param bits_per_key Число бит фильтра на ключ (10 бит дают около 1% ложных срабатываний).
+     * \post Фильтр пуст. При capacity == 0 фильтр выключен (is_enabled() == false).
+    */
+    explicit Blocked_bloom_filter(size_t capacity = 0, size_t bits_per_key = 10) {
+        if (capacity == 0 || bits_per_key == 0) {
+            return;
+        }
+
+        size_t count = (capacity * bits_per_key + block_bits - 1) / block_bits;
+        blocks.resize(count);
+
+        // оптимальное число проб k = ln 2 * m / n
+        probes = static_cast<int>(static_cast<double>(bits_per_key) * 0.693 + 0.5);
+        probes = probes < 1 ? 1 : (probes > max_probes ? max_probes : probes);
+    }
+
+    bool is_enabled() const { return !blocks.empty(); }
+
+    /**
+     * \brief Добавление хэша ключа.
+    */
+    void add(uint64_t hash) {
+        uint64_t h = mix(hash);
+        Block& block = blocks[block_index(h)];
+        uint64_t bits = mix(h);
+
+        for (int i = 0; i < probes; ++i, bits >>= 9) {
+            size_t bit = bits & (block_bits - 1);
+            block.words[bit / 64] |= uint64_t(1) << (bit % 64);
+        }
+        ++key_count;
+    }
+
+    /**
+     * \brief Проверка хэша ключа.
+     * \return false, если ключ точно не добавлялся; true, если ключ, возможно, добавлялся.
+    */
+    bool may_contain(uint64_t hash) const {
+        uint64_t h = mix(hash);
+        const Block& block = blocks[block_index(h)];
+        uint64_t bits = mix(h);
+
+        for (int i = 0; i < probes; ++i, bits >>= 9) {
+            size_t bit = bits & (block_bits - 1);
+            if ((block.words[bit / 64] & (uint64_t(1) << (bit % 64))) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * \brief Число добавленных ключей (с повторами).
+    */
+    size_t get_key_count() const { return key_count; }
+
+    /**
+     * \brief Ёмкость, на которую рассчитан фильтр при заданной плотности.
+    */
+    size_t get_capacity(size_t bits_per_key) const { return blocks.size() * block_bits / bits_per_key; }
+
+    /**
+     * \brief Объём памяти фильтра в байтах.
+    */
+    size_t get_memory() const { return blocks.size() * sizeof(Block); }
+
+    /**
+     * \brief Оценка вероятности ложного срабатывания по числу добавленных ключей.
+    */
+    double estimated_fpr() const {
+        if (blocks.empty()) {
+            return 1;
+        }
+
+        // доля единиц в блоке: 1 - exp(-k * n / m), возведённая в степень k
+        double load = static_cast<double>(probes) * static_cast<double>(key_count)
+                      / static_cast<double>(blocks.size() * block_bits);
+        return std::pow(1 - std::exp(-load), probes);
+    }
+
+    /**
+     * \brief Удаление всех ключей (размер фильтра сохраняется).
+    */
+    void reset() {
+        for (Block& block : blocks) {
+            block = Block();
+        }
+        key_count = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,334 @@
+#ifndef BUFFERED_TREE_H
+#define BUFFERED_TREE_H
+
+#include <vector>
+#include <optional>
+#include <utility>
+#include <algorithm> // for std::stable_sort, std::lower_bound
+#include "tree.h"
+#include "array_exception.h"
+
+/**
+ * \brief Дерево бинарного поиска с буферизацией записи.
+ *
+ * Вставки и удаления не спускаются в дерево сразу, а дописываются в журнал:
+ * небольшой неотсортированный хвост и стек отсортированных прогонов, размеры которых
+ * убывают хотя бы вдвое (как в LSM-дереве), поэтому каждая операция перемещается
+ * при слияниях O(log B) раз. Когда в буфере накапливается B операций, он применяется
+ * к дереву одним упорядоченным пакетом (BST::insert_sorted): соседние ключи пакета
+ * проходят по уже загруженным в кэш процессора путям.
+ * Поиск сначала проверяет буфер, поэтому чтение всегда видит последние записи.
+*/
+template<typename Key, typename Data>
+class Buffered_BST {
+private:
+    // Отложенный эффект для ключа: сначала (если erase) удалить ключ,
+    // затем (если есть data) вставить data, если ключа нет.
+    struct Op {
+        Key key;
+        bool erase;
+        std::optional<Data> data;
+    };
+
+    // Что известно о ключе по буферу.
+    enum class State {
+        unknown, // операций с ключом нет
+        absent,  // ключ удалён
+        present, // ключ будет вставлен с данными из буфера
+        maybe    // данные из буфера вставятся, только если ключа нет в дереве
+    };
+
+    BST<Key, Data> tree;
+    std::vector<Op> tail;              // новые операции в порядке поступления
+    std::vector<std::vector<Op>> runs; // от старых к новым, ключи внутри прогона уникальны
+    std::vector<Op> scratch;           // память для слияния прогонов
+    std::vector<std::pair<Key, Data>> batch; // пакет вставок при сбросе буфера
+    size_t tail_capacity;
+    size_t buffer_capacity;
+    size_t buffered = 0; // число операций в прогонах
+
+    // Композиция эффектов: сначала first, затем second.
+    static void compose(Op& first, Op&& second);
+
+    static bool key_less(const Op& a, const Op& b) { return a.key < b.key; }
+
+    // Слияние двух последних прогонов (предпоследний старше).
+    void merge_last_runs();
+
+    void seal_tail();
+
+    State resolve(const Key& key, Data*& data);
+
+    void push(Op&& op);
+
+public:
+    /**
+     * \brief Конструктор.
+     * \param buffer_size Число операций в буфере, при котором он сбрасывается в дерево.
+     * \param tail_size Размер неотсортированного хвоста буфера.
+     * \post Дерево и буфер пустые.
+    */
+    explicit Buffered_BST(size_t buffer_size = 65536, size_t tail_size = 64)
+        : tail_capacity(tail_size == 0 ? 1 : tail_size), buffer_capacity(buffer_size) {
+        tail.reserve(tail_capacity);
+    }
+
+    /**
+     * \brief Отложенная вставка данных с заданным ключом.
+     * \param key Ключ для вставки.
+     * \param data Данные для вставки.
+     * \post Если после применения буфера ключа в дереве нет, он будет вставлен с данными data.
+     * Как и BST::insert, существующий ключ не перезаписывается.
+    */
+    void insert(const Key& key, const Data& data) {
+        push(Op{ key, false, data });
+    }
+
+    /**
+     * \brief Отложенное удаление элемента с заданным ключом.
+     * \param key Ключ для удаления.
+     * \post После применения буфера ключа в дереве нет.
+    */
+    void remove(const Key& key) {
+        push(Op{ key, true, std::nullopt });
+    }
+
+    /**
+     * \brief Поиск элемента с заданным ключом с учётом отложенных операций.
+     * \param key Ключ для поиска.
+     * \return Ссылка на найденный элемент (в буфере или в дереве).
+     * Ссылка на элемент из буфера действительна до следующей операции записи.
+     * \throw Array_exception если элемент с заданным ключом не существует.
+    */
+    Data& at(const Key& key);
+
+    /**
+     * \brief Проверка наличия элемента с заданным ключом с учётом отложенных операций.
+     * \param key Ключ для поиска.
+     * \return true, если элемент существует, иначе false.
+    */
+    bool contains(const Key& key);
+
+    /**
+     * \brief Применение всех отложенных операций к дереву.
+     * \post Буфер пуст.
+    */
+    void flush();
+
+    /**
+     * \brief Получение размера дерева.
+     * \return Число элементов после применения буфера.
+     * \post Буфер пуст.
+    */
+    size_t get_size() {
+        flush();
+        return tree.get_size();
+    }
+
+    /**
+     * \brief Число отложенных операций в буфере (повторные операции с ключом могут быть уже слиты).
+    */
+    size_t get_pending() const { return buffered + tail.size(); }
+
+    /**
+     * \brief Формирование списка ключей в порядке возрастания.
+     * \post Буфер пуст.
+    */
+    std::vector<Key> get_keys() {
+        flush();
+        return tree.get_keys();
+    }
+
+    /**
+     * \brief Доступ к дереву после применения буфера.
+     * \post Буфер пуст.
+    */
+    BST<Key, Data>& get_tree() {
+        flush();
+        return tree;
+    }
+
+    /**
+     * \brief Очистка дерева и буфера.
+    */
+    void clear() {
+        tree.clear();
+        tail.clear();
+        runs.clear();
+        buffered = 0;
+    }
+};
+
+template <typename Key, typename Data>
+void Buffered_BST<Key, Data>::compose(Op& first, Op&& second) {
+    if (second.erase) { // удаление отменяет всё, что было раньше
+        first.erase = true;
+        first.data = std::move(second.data);
+    } else if (!first.data.has_value()) { // после first ключа точно нет
+        first.data = std::move(second.data);
+    } // иначе после first ключ точно есть, и вставка ничего не меняет
+}
+
+template <typename Key, typename Data>
+void Buffered_BST<Key, Data>::push(Op&& op) {
+    tail.push_back(std::move(op));
+
+    if (tail.size() >= tail_capacity) {
+        seal_tail();
+
+        if (buffered >= buffer_capacity) {
+            flush();
+        }
+    }
+}
+
+template <typename Key, typename Data>
+void Buffered_BST<Key, Data>::seal_tail() {
+    if (tail.empty()) {
+        return;
+    }
+
+    // устойчивая сортировка сохраняет порядок операций с одинаковым ключом
+    std::stable_sort(tail.begin(), tail.end(), key_less);
+
+    std::vector<Op> run;
+    run.reserve(tail.size());
+    for (Op& op : tail) {
+        if (!run.empty() && run.back().key == op.key) {
+            compose(run.back(), std::move(op));
+        } else {
+            run.push_back(std::move(op));
+        }
+    }
+    tail.clear();
+
+    buffered += run.size();
+    runs.push_back(std::move(run));
+
+    // поддерживаем убывание размеров прогонов хотя бы вдвое
+    while (runs.size() >= 2 && runs[runs.size() - 2].size() <= 2 * runs.back().size()) {
+        merge_last_runs();
+    }
+}
+
+template <typename Key, typename Data>
+void Buffered_BST<Key, Data>::merge_last_runs() {
+    std::vector<Op>& older = runs[runs.size() - 2];
+    std::vector<Op>& newer = runs.back();
+
+    scratch.clear();
+    scratch.reserve(older.size() + newer.size());
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < older.size() || j < newer.size()) {
+        if (j == newer.size() || (i < older.size() && older[i].key < newer[j].key)) {
+            scratch.push_back(std::move(older[i++]));
+        } else if (i == older.size() || newer[j].key < older[i].key) {
+            scratch.push_back(std::move(newer[j++]));
+        } else { // операции старого прогона применяются раньше
+            scratch.push_back(std::move(older[i++]));
+            compose(scratch.back(), std::move(newer[j++]));
+            --buffered;
+        }
+    }
+
+    older.swap(scratch);
+    runs.pop_back();
+}
+
+template <typename Key, typename Data>
+typename Buffered_BST<Key, Data>::State Buffered_BST<Key, Data>::resolve(const Key& key, Data*& data) {
+    State state = State::unknown;
+    data = nullptr;
+
+    auto apply = [&state, &data](Op& op) {
+        if (op.erase) {
+            state = op.data.has_value() ? State::present : State::absent;
+            data = op.data.has_value() ? &*op.data : nullptr;
+        } else if (state == State::unknown) {
+            state = State::maybe;
+            data = &*op.data;
+        } else if (state == State::absent) {
+            state = State::present;
+            data = &*op.data;
+        }
+    };
+
+    for (std::vector<Op>& run : runs) { // от старых операций к новым
+        auto it = std::lower_bound(run.begin(), run.end(), key,
+                                   [](const Op& op, const Key& k) { return op.key < k; });
+        if (it != run.end() && it->key == key) {
+            apply(*it);
+        }
+    }
+
+    for (Op& op : tail) {
+        if (op.key == key) {
+            apply(op);
+        }
+    }
+
+    return state;
+}
+
+template <typename Key, typename Data>
+Data& Buffered_BST<Key, Data>::at(const Key& key) {
+    Data* data = nullptr;
+
+    switch (resolve(key, data)) {
+    case State::absent:
+        throw Array_exception("No such key in BST");
+    case State::present:
+        return *data;
+    case State::maybe: // отложенная вставка применится, только если ключа нет в дереве
+        try {
+            return tree.at(key);
+        } catch (const Array_exception&) {
+            return *data;
+        }
+    default:
+        return tree.at(key);
+    }
+}
+
+template <typename Key, typename Data>
+bool Buffered_BST<Key, Data>::contains(const Key& key) {
+    Data* data = nullptr;
+    State state = resolve(key, data);
+
+    if (state != State::unknown) {
+        return state != State::absent;
+    }
+
+    return tree.contains(key);
+}
+
+template <typename Key, typename Data>
+void Buffered_BST<Key, Data>::flush() {
+    seal_tail();
+
+    while (runs.size() >= 2) {
+        merge_last_runs();
+    }
+
+    if (runs.empty()) {
+        return;
+    }
+
+    batch.clear();
+    for (Op& op : runs.back()) { // ключи идут по возрастанию
+        if (op.erase) {
+            tree.remove(op.key);
+        }
+        if (op.data.has_value()) {
+            batch.emplace_back(std::move(op.key), std::move(*op.data));
+        }
+    }
+
+    tree.insert_sorted(batch);
+    runs.clear();
+    buffered = 0;
+}
+
+#endif
@@ -0,0 +1,1023 @@
+#ifndef DISK_BTREE_H
+#define DISK_BTREE_H
+
+#include <vector>
+#include <string>
+#include <cstring> // for std::memcpy, std::strerror
+#include <cstdint>
+#include <cerrno>
+#include <algorithm> // for std::upper_bound, std::lower_bound
+#include <unordered_map>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>  // for open
+#include <unistd.h> // for pread, pwrite, fdatasync, ftruncate, close
+#include <sys/stat.h>
+#include "array_exception.h"
+
+constexpr size_t disk_page_size = 4096;
+
+struct alignas(64) Disk_page {
+    unsigned char bytes[disk_page_size];
+};
+
+/**
+ * \brief Счётчики буферного пула и журнала.
+*/
+struct Disk_stats {
+    size_t page_hits = 0;   // страница найдена в пуле
+    size_t page_misses = 0; // страница прочитана с диска
+    size_t evictions = 0;
+    size_t page_writes = 0; // записи страниц в файл данных
+    size_t commits = 0;     // групповые фиксации (по одному fdatasync журнала)
+    size_t wal_bytes = 0;   // записано в журнал
+    size_t checkpoints = 0;
+};
+
+/**
+ * \brief Журнал упреждающей записи (write-ahead log) из образов страниц.
+ *
+ * Единица записи - пакет: заголовок {magic, число страниц, контрольная сумма} и образы
+ * страниц после изменения. Пакет либо применяется при восстановлении целиком,
+ * либо (оборванная запись, неверная сумма) отбрасывается вместе со всем, что после него.
+*/
+class Write_ahead_log {
+private:
+    static constexpr uint32_t batch_magic = 0x57414c42; // "WALB"
+
+    struct Batch_header {
+        uint32_t magic;
+        uint32_t page_count;
+        uint64_t checksum;
+    };
+
+    int fd = -1;
+    size_t file_size = 0;
+    std::vector<unsigned char> batch; // заголовок и записи текущего пакета
+    uint32_t batch_pages = 0;
+
+    static uint64_t checksum(const unsigned char* bytes, size_t count) {
+        uint64_t hash = 0xcbf29ce484222325ull; // FNV-1a
+        for (size_t i = 0; i < count; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+public:
+    static constexpr size_t record_size = sizeof(uint32_t) + disk_page_size;
+
+    Write_ahead_log() = default;
+    Write_ahead_log(const Write_ahead_log&) = delete;
+    Write_ahead_log& operator=(const Write_ahead_log&) = delete;
+
+    ~Write_ahead_log() { close(); }
+
+    void open(const std::string& path) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw Array_exception("Cannot open " + path + ": " + std::strerror(errno));
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            int error = errno;
+            close();
+            throw Array_exception("Cannot stat " + path + ": " + std::strerror(error));
+        }
+        file_size = static_cast<size_t>(info.st_size);
+    }
+
+    void close() {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        batch.clear();
+        batch_pages = 0;
+    }
+
+    size_t get_size() const { return file_size; }
+
+    /**
+     * \brief Добавление образа страницы в текущий пакет.
+    */
+    void append(uint32_t page_id, const Disk_page& page) {
+        if (batch.empty()) {
+            batch.resize(sizeof(Batch_header));
+        }
+
+        size_t offset = batch.size();
+        batch.resize(offset + record_size);
+        std::memcpy(batch.data() + offset, &page_id, sizeof(page_id));
+        std::memcpy(batch.data() + offset + sizeof(page_id), page.bytes, disk_page_size);
+        ++batch_pages;
+    }
+
+    /**
+     * \brief Отказ от текущего пакета (например, после неудачной записи).
+    */
+    void discard() {
+        batch.clear();
+        batch_pages = 0;
+    }
+
+    /**
+     * \brief Запись пакета в конец журнала и fdatasync.
+     * \return Число записанных байт.
+     * \throw Array_exception при ошибке записи; недописанный хвост журнала перезапишет следующий пакет.
+    */
+    size_t commit() {
+        if (batch_pages == 0) {
+            return 0;
+        }
+
+        Batch_header header{ batch_magic, batch_pages,
+                             checksum(batch.data() + sizeof(Batch_header), batch.size() - sizeof(Batch_header)) };
+        std::memcpy(batch.data(), &header, sizeof(header));
+
+        size_t written = 0;
+        while (written < batch.size()) {
+            ssize_t result = pwrite(fd, batch.data() + written, batch.size() - written,
+                                    static_cast<off_t>(file_size + written));
+            if (result < 0) {
+                throw Array_exception(std::string("WAL write failed: ") + std::strerror(errno));
+            }
+            written += static_cast<size_t>(result);
+        }
+
+        if (fdatasync(fd) != 0) {
+            throw Array_exception(std::string("WAL sync failed: ") + std::strerror(errno));
+        }
+
+        file_size += written;
+        batch.clear();
+        batch_pages = 0;
+        return written;
+    }
+
+    /**
+     * \brief Очистка журнала после того, как все его страницы надёжно записаны в файл данных.
+    */
+    void reset() {
+        if (ftruncate(fd, 0) != 0 || fdatasync(fd) != 0) {
+            throw Array_exception(std::string("WAL truncate failed: ") + std::strerror(errno));
+        }
+        file_size = 0;
+    }
+
+    /**
+     * \brief Повтор целых пакетов журнала: apply(page_id, page) для каждой страницы по порядку.
+     * \return Число применённых пакетов.
+    */
+    template<typename Apply>
+    size_t replay(Apply apply) {
+        std::vector<unsigned char> content(file_size);
+        size_t loaded = 0;
+        while (loaded < file_size) {
+            ssize_t result = pread(fd, content.data() + loaded, file_size - loaded, static_cast<off_t>(loaded));
+            if (result <= 0) {
+                break;
+            }
+            loaded += static_cast<size_t>(result);
+        }
+
+        size_t batches = 0;
+        size_t offset = 0;
+        while (offset + sizeof(Batch_header) <= loaded) {
+            Batch_header header;
+            std::memcpy(&header, content.data() + offset, sizeof(header));
+            size_t payload = static_cast<size_t>(header.page_count) * record_size;
+
+            if (header.magic != batch_magic || offset + sizeof(header) + payload > loaded ||
+                checksum(content.data() + offset + sizeof(header), payload) != header.checksum) {
+                break; // оборванный хвост: всё дальше не было зафиксировано
+            }
+
+            const unsigned char* record = content.data() + offset + sizeof(header);
+            for (uint32_t i = 0; i < header.page_count; ++i, record += record_size) {
+                uint32_t page_id;
+                Disk_page page;
+                std::memcpy(&page_id, record, sizeof(page_id));
+                std::memcpy(page.bytes, record + sizeof(page_id), disk_page_size);
+                apply(page_id, page);
+            }
+
+            offset += sizeof(header) + payload;
+            ++batches;
+        }
+
+        return batches;
+    }
+};
+
+class Buffer_pool;
+
+/**
+ * \brief Закрепление страницы в пуле: пока объект жив, страница не вытесняется.
+*/
+class Page_guard {
+private:
+    Buffer_pool* pool = nullptr;
+    size_t frame = 0;
+
+public:
+    Page_guard() = default;
+    Page_guard(Buffer_pool* p, size_t f) : pool(p), frame(f) {}
+
+    Page_guard(const Page_guard&) = delete;
+    Page_guard& operator=(const Page_guard&) = delete;
+
+    Page_guard(Page_guard&& other) noexcept : pool(other.pool), frame(other.frame) { other.pool = nullptr; }
+
+    Page_guard& operator=(Page_guard&& other) noexcept {
+        if (this != &other) {
+            release();
+            pool = other.pool;
+            frame = other.frame;
+            other.pool = nullptr;
+        }
+        return *this;
+    }
+
+    ~Page_guard() { release(); }
+
+    template<typename T>
+    T* as();
+
+    uint32_t page_id() const;
+
+    // Страница изменена текущей операцией: попадёт в следующий пакет журнала.
+    void mark_dirty();
+
+    void release();
+};
+
+/**
+ * \brief Буферный пул страниц файла фиксированного размера с вытеснением по алгоритму CLOCK.
+ *
+ * Изменённые страницы сначала фиксируются в журнале (commit), и только затем могут быть
+ * вытеснены в файл данных, поэтому файл данных никогда не содержит незафиксированных изменений.
+ * Контрольная точка (checkpoint) записывает все изменённые страницы, синхронизирует
+ * файл данных и очищает журнал. При открытии зафиксированные пакеты журнала повторяются.
+*/
+class Buffer_pool {
+private:
+    static constexpr uint32_t no_page = UINT32_MAX;
+
+    struct Frame {
+        uint32_t page_id = no_page;
+        uint32_t pins = 0;
+        bool referenced = false;  // бит CLOCK
+        bool dirty = false;       // отличается от файла данных
+        bool uncommitted = false; // изменена после последней фиксации
+    };
+
+    int fd = -1;
+    Write_ahead_log wal;
+    std::vector<Disk_page> pages;
+    std::vector<Frame> frames;
+    std::unordered_map<uint32_t, size_t> page_table;
+    size_t clock_hand = 0;
+    size_t uncommitted_count = 0;
+    size_t checkpoint_bytes;
+    bool fresh_file = false;
+    Disk_stats stats;
+
+    friend class Page_guard;
+
+    void write_page(uint32_t page_id, const Disk_page& page) {
+        ssize_t result = pwrite(fd, page.bytes, disk_page_size, static_cast<off_t>(page_id) * disk_page_size);
+        if (result != static_cast<ssize_t>(disk_page_size)) {
+            throw Array_exception(std::string("Page write failed: ") + std::strerror(errno));
+        }
+        ++stats.page_writes;
+    }
+
+    // Свободный кадр: незакреплённый и без незафиксированных изменений, по алгоритму CLOCK.
+    size_t find_victim() {
+        for (size_t scanned = 0; scanned < 2 * frames.size() + 1; ++scanned) {
+            size_t index = clock_hand;
+            clock_hand = (clock_hand + 1) % frames.size();
+            Frame& frame = frames[index];
+
+            if (frame.page_id == no_page) {
+                return index;
+            }
+            if (frame.pins > 0 || frame.uncommitted) {
+                continue;
+            }
+            if (frame.referenced) { // второй шанс
+                frame.referenced = false;
+                continue;
+            }
+
+            if (frame.dirty) { // образ уже в журнале, можно писать в файл данных
+                write_page(frame.page_id, pages[index]);
+            }
+            page_table.erase(frame.page_id);
+            frame = Frame();
+            ++stats.evictions;
+            return index;
+        }
+
+        throw Array_exception("Buffer pool is exhausted");
+    }
+
+    size_t load(uint32_t page_id, bool create) {
+        auto found = page_table.find(page_id);
+        if (found != page_table.end()) {
+            ++stats.page_hits;
+            return found->second;
+        }
+
+        size_t index = find_victim();
+        Disk_page& page = pages[index];
+        std::memset(page.bytes, 0, disk_page_size);
+
+        if (!create) {
+            ++stats.page_misses;
+            ssize_t result = pread(fd, page.bytes, disk_page_size, static_cast<off_t>(page_id) * disk_page_size);
+            if (result < 0) {
+                throw Array_exception(std::string("Page read failed: ") + std::strerror(errno));
+            }
+        }
+
+        frames[index].page_id = page_id;
+        page_table[page_id] = index;
+        return index;
+    }
+
+public:
+    /**
+     * \brief Открытие файла данных path и журнала path + ".wal" с восстановлением после сбоя.
+     * \param path Путь к файлу данных.
+     * \param frame_count Число страниц в пуле.
+     * \param checkpoint_size Размер журнала в байтах, после которого выполняется контрольная точка.
+     * \throw Array_exception при ошибке ввода-вывода.
+    */
+    Buffer_pool(const std::string& path, size_t frame_count, size_t checkpoint_size = 16u << 20)
+        : pages(frame_count), frames(frame_count), checkpoint_bytes(checkpoint_size) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw Array_exception("Cannot open " + path + ": " + std::strerror(errno));
+        }
+
+        // деструктор не вызывается для недостроенного объекта, поэтому файл закрывается здесь
+        try {
+            wal.open(path + ".wal");
+
+            // повтор зафиксированных пакетов: образы страниц идемпотентны
+            size_t replayed = wal.replay([this](uint32_t page_id, const Disk_page& page) { write_page(page_id, page); });
+            if (replayed > 0 && fdatasync(fd) != 0) {
+                throw Array_exception(std::string("Data sync failed: ") + std::strerror(errno));
+            }
+            wal.reset();
+
+            struct stat info;
+            if (fstat(fd, &info) != 0) {
+                throw Array_exception("Cannot stat " + path + ": " + std::strerror(errno));
+            }
+            fresh_file = (info.st_size == 0);
+        } catch (...) {
+            ::close(fd);
+            fd = -1;
+            throw;
+        }
+    }
+
+    Buffer_pool(const Buffer_pool&) = delete;
+    Buffer_pool& operator=(const Buffer_pool&) = delete;
+
+    ~Buffer_pool() {
+        if (fd < 0) {
+            return;
+        }
+
+        try {
+            commit();
+            checkpoint();
+        } catch (const Array_exception&) { // деструктор не бросает; журнал восстановит данные
+        }
+        ::close(fd);
+    }
+
+    bool is_fresh() const { return fresh_file; }
+
+    size_t get_frame_count() const { return frames.size(); }
+
+    size_t get_uncommitted() const { return uncommitted_count; }
+
+    const Disk_stats& get_stats() const { return stats; }
+
+    /**
+     * \brief Закрепление страницы (с чтением с диска при промахе).
+    */
+    Page_guard fetch(uint32_t page_id) {
+        size_t index = load(page_id, false);
+        ++frames[index].pins;
+        frames[index].referenced = true;
+        return Page_guard(this, index);
+    }
+
+    /**
+     * \brief Закрепление новой страницы, заполненной нулями, без чтения с диска.
+    */
+    Page_guard create(uint32_t page_id) {
+        size_t index = load(page_id, true);
+        std::memset(pages[index].bytes, 0, disk_page_size);
+        ++frames[index].pins;
+        frames[index].referenced = true;
+        return Page_guard(this, index);
+    }
+
+    /**
+     * \brief Групповая фиксация: образы всех изменённых с прошлой фиксации страниц
+     * записываются в журнал одним пакетом с одним fdatasync.
+    */
+    void commit() {
+        if (uncommitted_count == 0) {
+            return;
+        }
+
+        for (size_t i = 0; i < frames.size(); ++i) {
+            if (frames[i].uncommitted) {
+                wal.append(frames[i].page_id, pages[i]);
+            }
+        }
+
+        // страницы считаются зафиксированными только после fdatasync журнала: иначе их можно
+        // было бы вытеснить в файл данных; при ошибке следующая фиксация соберёт пакет заново
+        try {
+            stats.wal_bytes += wal.commit();
+        } catch (...) {
+            wal.discard();
+            throw;
+        }
+        ++stats.commits;
+
+        for (Frame& frame : frames) {
+            frame.uncommitted = false;
+        }
+        uncommitted_count = 0;
+
+        if (wal.get_size() >= checkpoint_bytes) {
+            checkpoint();
+        }
+    }
+
+    /**
+     * \brief Контрольная точка: запись изменённых страниц в файл данных и очистка журнала.
+     * \pre Незафиксированных изменений нет.
+    */
+    void checkpoint() {
+        for (size_t i = 0; i < frames.size(); ++i) {
+            if (frames[i].dirty && !frames[i].uncommitted) {
+                write_page(frames[i].page_id, pages[i]);
+                frames[i].dirty = false;
+            }
+        }
+
+        if (fdatasync(fd) != 0) {
+            throw Array_exception(std::string("Data sync failed: ") + std::strerror(errno));
+        }
+        wal.reset();
+        ++stats.checkpoints;
+    }
+
+    /**
+     * \brief Имитация аварийного завершения процесса: содержимое пула теряется без записи.
+     * \post Пул закрыт; данные восстанавливаются из журнала при следующем открытии.
+    */
+    void crash() {
+        wal.close();
+        ::close(fd);
+        fd = -1;
+        page_table.clear();
+        frames.assign(frames.size(), Frame());
+        uncommitted_count = 0;
+    }
+};
+
+template<typename T>
+T* Page_guard::as() {
+    return reinterpret_cast<T*>(pool->pages[frame].bytes);
+}
+
+inline uint32_t Page_guard::page_id() const {
+    return pool->frames[frame].page_id;
+}
+
+inline void Page_guard::mark_dirty() {
+    Buffer_pool::Frame& info = pool->frames[frame];
+    info.dirty = true;
+    if (!info.uncommitted) {
+        info.uncommitted = true;
+        ++pool->uncommitted_count;
+    }
+}
+
+inline void Page_guard::release() {
+    if (pool != nullptr) {
+        --pool->frames[frame].pins;
+        pool = nullptr;
+    }
+}
+
+/**
+ * \brief Упорядоченное отображение во внешней памяти: B+-дерево в файле из страниц по 4 КБ.
+ *
+ * Данные хранятся только в листьях, листья связаны в список для упорядоченного обхода.
+ * Страницы читаются через буферный пул фиксированного размера, каждая операция записи
+ * атомарна относительно сбоя: изменения фиксируются в журнале группами по group_commit
+ * операций (одна синхронизация на группу), sync() фиксирует немедленно.
+ * После сбоя дерево восстанавливается в состояние на момент последней фиксации.
+ * Ключи и данные копируются в страницы побайтно, поэтому должны быть тривиально копируемыми.
+ * Удаление не объединяет страницы: недозаполненные листья остаются в дереве.
+*/
+template<typename Key, typename Data>
+class Disk_btree {
+private:
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Data>,
+                  "Disk_btree stores keys and data as raw bytes");
+
+    static constexpr uint64_t file_magic = 0x4254524545444b31ull; // "BTREEDK1"
+    static constexpr uint32_t meta_page = 0;
+    static constexpr uint32_t no_page = 0; // нулевая страница - метаданные, поэтому 0 означает "нет"
+
+    struct Page_header {
+        uint32_t is_leaf;
+        uint32_t count;
+        uint32_t next; // следующий лист
+        uint32_t unused;
+    };
+
+    static constexpr size_t leaf_capacity =
+        (disk_page_size - sizeof(Page_header) - alignof(Data)) / (sizeof(Key) + sizeof(Data));
+    static constexpr size_t inner_capacity =
+        (disk_page_size - sizeof(Page_header) - 2 * sizeof(uint32_t)) / (sizeof(Key) + sizeof(uint32_t));
+
+    struct Leaf {
+        Page_header header;
+        Key keys[leaf_capacity];
+        Data values[leaf_capacity];
+    };
+
+    // Потомок children[i] содержит ключи из [keys[i - 1], keys[i]).
+    struct Inner {
+        Page_header header;
+        Key keys[inner_capacity];
+        uint32_t children[inner_capacity + 1];
+    };
+
+    struct Meta {
+        uint64_t magic;
+        uint32_t root;
+        uint32_t page_count;
+        uint64_t size;
+        uint32_t height; // число уровней
+        uint32_t key_size;
+        uint32_t data_size;
+    };
+
+    static_assert(leaf_capacity >= 4 && inner_capacity >= 4, "Key and data are too large for a page");
+    static_assert(sizeof(Leaf) <= disk_page_size && sizeof(Inner) <= disk_page_size);
+
+    Buffer_pool pool;
+    size_t group_commit;
+    size_t pending_ops = 0; // операций с последней фиксации
+
+    // Путь от корня до листа: закреплённые страницы и номера выбранных потомков.
+    struct Path_step {
+        Page_guard page;
+        size_t child;
+    };
+
+    void init_empty();
+
+    Page_guard find_leaf(const Key& key);
+
+    // Фиксация по числу операций или по нехватке кадров для следующей операции.
+    void finish_operation(const Meta* meta);
+
+    // Вставка разделителя и новой правой страницы в родителя с расщеплением вверх по пути.
+    void insert_separator(std::vector<Path_step>& path, Meta* meta, Key separator, uint32_t right_id);
+
+public:
+    /**
+     * \brief Открытие (или создание) дерева в файле.
+     * \param path Путь к файлу данных; журнал хранится рядом в path + ".wal".
+     * \param pool_pages Размер буферного пула в страницах (не меньше 16).
+     * \param group_commit Число операций записи в одной групповой фиксации журнала.
+     * \throw Array_exception при ошибке ввода-вывода или несовпадении формата файла.
+    */
+    explicit Disk_btree(const std::string& path, size_t pool_pages = 1024, size_t group_commit = 64);
+
+    Disk_btree(const Disk_btree&) = delete;
+    Disk_btree& operator=(const Disk_btree&) = delete;
+
+    /**
+     * \brief Деструктор: фиксация оставшихся операций и контрольная точка.
+    */
+    ~Disk_btree() = default;
+
+    /**
+     * \brief Получение числа элементов.
+    */
+    size_t get_size();
+
+    bool is_empty() { return get_size() == 0; }
+
+    /**
+     * \brief Вставляет данные с заданным ключом.
+     * \return true, если элемент был вставлен, иначе false (ключ уже есть).
+    */
+    bool insert(const Key& key, const Data& data);
+
+    /**
+     * \brief Удаляет элемент с заданным ключом.
+     * \return true, если элемент был удалён, иначе false.
+    */
+    bool remove(const Key& key);
+
+    /**
+     * \brief Поиск элемента с заданным ключом.
+     * \return Копия данных: страница может быть вытеснена из пула после возврата.
+     * \throw Array_exception если элемент с заданным ключом не существует.
+    */
+    Data at(const Key& key);
+
+    Data operator[](const Key& key) { return at(key); }
+
+    /**
+     * \brief Проверка наличия элемента с заданным ключом.
+    */
+    bool contains(const Key& key);
+
+    /**
+     * \brief Формирование списка ключей в порядке возрастания.
+    */
+    std::vector<Key> get_keys();
+
+    /**
+     * \brief Очистка дерева. Место в файле не освобождается.
+    */
+    void clear();
+
+    /**
+     * \brief Немедленная фиксация всех выполненных операций (fdatasync журнала).
+     * \post После возврата операции переживут сбой.
+    */
+    void sync();
+
+    /**
+     * \brief Имитация аварийного завершения для тестов: незафиксированные операции теряются.
+     * \post Объект нельзя использовать; данные восстанавливаются при следующем открытии файла.
+    */
+    void simulate_crash() { pool.crash(); }
+
+    const Disk_stats& get_stats() const { return pool.get_stats(); }
+
+    /**
+     * \brief Прямой итератор по парам (ключ, данные) в порядке возрастания ключей.
+     * Лист копируется в итератор целиком; итератор недействителен после изменения дерева.
+    */
+    class Iterator {
+    private:
+        Disk_btree* tree = nullptr;
+        uint32_t leaf = no_page; // no_page - конец
+        uint32_t next_leaf = no_page;
+        size_t index = 0;
+        std::vector<std::pair<Key, Data>> entries;
+
+        // Загрузка первого непустого листа, начиная с leaf_id.
+        void load(uint32_t leaf_id) {
+            while (leaf_id != no_page) {
+                Page_guard page = tree->pool.fetch(leaf_id);
+                Leaf* node = page.as<Leaf>();
+
+                entries.clear();
+                for (uint32_t i = 0; i < node->header.count; ++i) {
+                    entries.emplace_back(node->keys[i], node->values[i]);
+                }
+                leaf = leaf_id;
+                next_leaf = node->header.next;
+                index = 0;
+
+                if (!entries.empty()) {
+                    return;
+                }
+                leaf_id = next_leaf;
+            }
+
+            leaf = no_page;
+            index = 0;
+            entries.clear();
+        }
+
+    public:
+        Iterator() = default;
+
+        Iterator(Disk_btree* t, uint32_t first_leaf) : tree(t) { load(first_leaf); }
+
+        const std::pair<Key, Data>& operator*() const {
+            if (leaf == no_page) {
+                throw Array_exception("Iterator is not initialized");
+            }
+            return entries[index];
+        }
+
+        const std::pair<Key, Data>* operator->() const { return &**this; }
+
+        Iterator& operator++() {
+            if (leaf == no_page) {
+                throw Array_exception("Cannot move past end of the tree");
+            }
+
+            if (++index == entries.size()) {
+                load(next_leaf);
+            }
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const { return leaf == other.leaf && index == other.index; }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+    };
+
+    Iterator begin();
+
+    Iterator end() { return Iterator(); }
+};
+
+template <typename Key, typename Data>
+Disk_btree<Key, Data>::Disk_btree(const std::string& path, size_t pool_pages, size_t group)
+    : pool(path, pool_pages < 16 ? 16 : pool_pages), group_commit(group == 0 ? 1 : group) {
+    if (pool.is_fresh()) {
+        init_empty();
+        sync();
+        return;
+    }
+
+    Page_guard page = pool.fetch(meta_page);
+    Meta* meta = page.as<Meta>();
+    if (meta->magic != file_magic || meta->key_size != sizeof(Key) || meta->data_size != sizeof(Data)) {
+        throw Array_exception("File " + path + " is not a Disk_btree of this type");
+    }
+}
+
+template <typename Key, typename Data>
+void Disk_btree<Key, Data>::init_empty() {
+    Page_guard page = pool.create(meta_page);
+    Meta* meta = page.as<Meta>();
+    *meta = Meta{ file_magic, 1, 2, 0, 1, sizeof(Key), sizeof(Data) };
+    page.mark_dirty();
+
+    Page_guard root = pool.create(1);
+    root.as<Leaf>()->header = Page_header{ 1, 0, no_page, 0 };
+    root.mark_dirty();
+}
+
+template <typename Key, typename Data>
+void Disk_btree<Key, Data>::finish_operation(const Meta* meta) {
+    ++pending_ops;
+
+    // операция закрепляет и изменяет не больше двух страниц на уровень
+    size_t reserve = 2 * static_cast<size_t>(meta->height) + 4;
+    if (pending_ops >= group_commit || pool.get_uncommitted() + reserve > pool.get_frame_count()) {
+        pool.commit();
+        pending_ops = 0;
+    }
+}
+
+template <typename Key, typename Data>
+void Disk_btree<Key, Data>::sync() {
+    pool.commit();
+    pending_ops = 0;
+}
+
+template <typename Key, typename Data>
+size_t Disk_btree<Key, Data>::get_size() {
+    Page_guard page = pool.fetch(meta_page);
+    return static_cast<size_t>(page.as<Meta>()->size);
+}
+
+template <typename Key, typename Data>
+Page_guard Disk_btree<Key, Data>::find_leaf(const Key& key) {
+    uint32_t root = pool.fetch(meta_page).as<Meta>()->root;
+    Page_guard page = pool.fetch(root);
+
+    while (!page.as<Page_header>()->is_leaf) {
+        Inner* node = page.as<Inner>();
+        size_t child = std::upper_bound(node->keys, node->keys + node->header.count, key) - node->keys;
+        page = pool.fetch(node->children[child]);
+    }
+
+    return page;
+}
+
+template <typename Key, typename Data>
+Data Disk_btree<Key, Data>::at(const Key& key) {
+    Page_guard page = find_leaf(key);
+    Leaf* leaf = page.as<Leaf>();
+
+    Key* end = leaf->keys + leaf->header.count;
+    Key* found = std::lower_bound(leaf->keys, end, key);
+    if (found == end || key < *found) {
+        throw Array_exception("No such key in Disk_btree");
+    }
+
+    return leaf->values[found - leaf->keys];
+}
+
+template <typename Key, typename Data>
+bool Disk_btree<Key, Data>::contains(const Key& key) {
+    Page_guard page = find_leaf(key);
+    Leaf* leaf = page.as<Leaf>();
+
+    Key* end = leaf->keys + leaf->header.count;
+    Key* found = std::lower_bound(leaf->keys, end, key);
+    return found != end && !(key < *found);
+}
+
+template <typename Key, typename Data>
+bool Disk_btree<Key, Data>::insert(const Key& key, const Data& data) {
+    Page_guard meta_guard = pool.fetch(meta_page);
+    Meta* meta = meta_guard.as<Meta>();
+
+    std::vector<Path_step> path;
+    Page_guard page = pool.fetch(meta->root);
+    while (!page.as<Page_header>()->is_leaf) {
+        Inner* node = page.as<Inner>();
+        size_t child = std::upper_bound(node->keys, node->keys + node->header.count, key) - node->keys;
+        uint32_t child_id = node->children[child];
+        path.push_back(Path_step{ std::move(page), child });
+        page = pool.fetch(child_id);
+    }
+
+    Leaf* leaf = page.as<Leaf>();
+    size_t count = leaf->header.count;
+    size_t pos = std::lower_bound(leaf->keys, leaf->keys + count, key) - leaf->keys;
+    if (pos < count && !(key < leaf->keys[pos])) { // дубликаты запрещены
+        return false;
+    }
+
+    if (count < leaf_capacity) {
+        std::memmove(leaf->keys + pos + 1, leaf->keys + pos, (count - pos) * sizeof(Key));
+        std::memmove(leaf->values + pos + 1, leaf->values + pos, (count - pos) * sizeof(Data));
+        leaf->keys[pos] = key;
+        leaf->values[pos] = data;
+        ++leaf->header.count;
+        page.mark_dirty();
+    } else { // расщепление листа: правая половина уходит в новую страницу
+        uint32_t right_id = meta->page_count++;
+        Page_guard right_page = pool.create(right_id);
+        Leaf* right = right_page.as<Leaf>();
+
+        size_t total = count + 1;
+        size_t left_count = total / 2;
+        std::vector<Key> keys(leaf->keys, leaf->keys + count);
+        std::vector<Data> values(leaf->values, leaf->values + count);
+        keys.insert(keys.begin() + pos, key);
+        values.insert(values.begin() + pos, data);
+
+        std::memcpy(leaf->keys, keys.data(), left_count * sizeof(Key));
+        std::memcpy(leaf->values, values.data(), left_count * sizeof(Data));
+        std::memcpy(right->keys, keys.data() + left_count, (total - left_count) * sizeof(Key));
+        std::memcpy(right->values, values.data() + left_count, (total - left_count) * sizeof(Data));
+
+        right->header = Page_header{ 1, static_cast<uint32_t>(total - left_count), leaf->header.next, 0 };
+        leaf->header.count = static_cast<uint32_t>(left_count);
+        leaf->header.next = right_id;
+        page.mark_dirty();
+        right_page.mark_dirty();
+
+        path.push_back(Path_step{ std::move(page), 0 });
+        insert_separator(path, meta, right->keys[0], right_id);
+    }
+
+    ++meta->size;
+    meta_guard.mark_dirty();
+    finish_operation(meta);
+    return true;
+}
+
+template <typename Key, typename Data>
+void Disk_btree<Key, Data>::insert_separator(std::vector<Path_step>& path, Meta* meta, Key separator, uint32_t right_id) {
+    // path.back() - расщеплённая страница, выше - её предки
+    while (true) {
+        uint32_t left_id = path.back().page.page_id();
+        path.pop_back();
+
+        if (path.empty()) { // расщепился корень: дерево растёт на уровень
+            uint32_t root_id = meta->page_count++;
+            Page_guard root_page = pool.create(root_id);
+            Inner* root = root_page.as<Inner>();
+            root->header = Page_header{ 0, 1, no_page, 0 };
+            root->keys[0] = separator;
+            root->children[0] = left_id;
+            root->children[1] = right_id;
+            root_page.mark_dirty();
+
+            meta->root = root_id;
+            ++meta->height;
+            return;
+        }
+
+        Page_guard& page = path.back().page;
+        size_t pos = path.back().child;
+        Inner* node = page.as<Inner>();
+        size_t count = node->header.count;
+
+        if (count < inner_capacity) {
+            std::memmove(node->keys + pos + 1, node->keys + pos, (count - pos) * sizeof(Key));
+            std::memmove(node->children + pos + 2, node->children + pos + 1, (count - pos) * sizeof(uint32_t));
+            node->keys[pos] = separator;
+            node->children[pos + 1] = right_id;
+            ++node->header.count;
+            page.mark_dirty();
+            return;
+        }
+
+        // расщепление внутреннего узла: средний ключ поднимается к родителю
+        std::vector<Key> keys(node->keys, node->keys + count);
+        std::vector<uint32_t> children(node->children, node->children + count + 1);
+        keys.insert(keys.begin() + pos, separator);
+        children.insert(children.begin() + pos + 1, right_id);
+
+        size_t total = count + 1;
+        size_t middle = total / 2;
+
+        uint32_t new_id = meta->page_count++;
+        Page_guard right_page = pool.create(new_id);
+        Inner* right = right_page.as<Inner>();
+
+        std::memcpy(node->keys, keys.data(), middle * sizeof(Key));
+        std::memcpy(node->children, children.data(), (middle + 1) * sizeof(uint32_t));
+        node->header.count = static_cast<uint32_t>(middle);
+
+        right->header = Page_header{ 0, static_cast<uint32_t>(total - middle - 1), no_page, 0 };
+        std::memcpy(right->keys, keys.data() + middle + 1, (total - middle - 1) * sizeof(Key));
+        std::memcpy(right->children, children.data() + middle + 1, (total - middle) * sizeof(uint32_t));
+
+        page.mark_dirty();
+        right_page.mark_dirty();
+
+        separator = keys[middle];
+        right_id = new_id;
+    }
+}
+
+template <typename Key, typename Data>
+bool Disk_btree<Key, Data>::remove(const Key& key) {
+    Page_guard meta_guard = pool.fetch(meta_page);
+    Meta* meta = meta_guard.as<Meta>();
+
+    Page_guard page = find_leaf(key);
+    Leaf* leaf = page.as<Leaf>();
+    size_t count = leaf->header.count;
+    size_t pos = std::lower_bound(leaf->keys, leaf->keys + count, key) - leaf->keys;
+    if (pos == count || key < leaf->keys[pos]) { // элемента с заданным ключом не существует
+        return false;
+    }
+
+    std::memmove(leaf->keys + pos, leaf->keys + pos + 1, (count - pos - 1) * sizeof(Key));
+    std::memmove(leaf->values + pos, leaf->values + pos + 1, (count - pos - 1) * sizeof(Data));
+    --leaf->header.count;
+    page.mark_dirty();
+
+    --meta->size;
+    meta_guard.mark_dirty();
+    finish_operation(meta);
+    return true;
+}
+
+template <typename Key, typename Data>
+void Disk_btree<Key, Data>::clear() {
+    init_empty();
+    sync();
+}
+
+template <typename Key, typename Data>
+typename Disk_btree<Key, Data>::Iterator Disk_btree<Key, Data>::begin() {
+    uint32_t root = pool.fetch(meta_page).as<Meta>()->root;
+    Page_guard page = pool.fetch(root);
+
+    while (!page.as<Page_header>()->is_leaf) { // самый левый лист
+        page = pool.fetch(page.as<Inner>()->children[0]);
+    }
+
+    uint32_t first = page.page_id();
+    page.release();
+    return Iterator(this, first);
+}
+
+template <typename Key, typename Data>
+std::vector<Key> Disk_btree<Key, Data>::get_keys() {
+    std::vector<Key> keys;
+    for (Iterator it = begin(); it != end(); ++it) {
+        keys.push_back(it->first);
+    }
+    return keys;
+}
+
+#endif
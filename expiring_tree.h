@@ -0,0 +1,281 @@
+#ifndef EXPIRING_TREE_H
+#define EXPIRING_TREE_H
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <memory>  // for std::unique_ptr
+#include <utility> // for std::move, std::swap
+#include "tree.h"
+#include "array_exception.h"
+
+/**
+ * \brief Дерево бинарного поиска с временем жизни элементов (TTL).
+ *
+ * Каждый элемент хранит момент истечения. Рядом с деревом ключей ведётся индекс сроков -
+ * двоичная куча по моменту истечения, в которой каждый элемент знает свою позицию,
+ * поэтому просроченный элемент всегда на вершине, а продление и удаление стоят O(log n).
+ * expire_until() удаляет k элементов за O(k log n) ограниченными порциями, без обхода
+ * всего дерева. До удаления просроченный элемент логически отсутствует: поиск его пропускает.
+ * Моменты истечения поступают почти по возрастанию, и сбалансированное дерево сроков
+ * перестраивало бы поддеревья с паузами O(n); куча таких перестроек не делает.
+ * Время задаётся вызывающим кодом (например, миллисекунды монотонных часов).
+*/
+template<typename Key, typename Data, typename Time = uint64_t>
+class Expiring_BST {
+private:
+    struct Entry {
+        Data data;
+        Time expires; // элемент жив, пока now < expires
+        size_t slot;  // позиция в куче сроков
+    };
+
+    struct Deadline {
+        Time expires;
+        Key key;
+        // Узлы дерева не перемещаются: удаление и балансировка только перевязывают их.
+        // Указатель остаётся действительным лишь потому, что дерево закрыто и compact(),
+        // compact_step() и extract() для него никогда не вызываются.
+        Entry* entry;
+    };
+
+    using Tree = BST<Key, Entry>;
+
+    // Дерево в отдельном блоке: при перемещении контейнера узлы остаются на месте,
+    // и указатели кучи на них не меняются.
+    std::unique_ptr<Tree> tree;
+    std::vector<Deadline> heap; // наименьший срок в heap[0]
+
+    Entry* live_entry(const Key& key, Time now) {
+        Entry* entry = tree->find(key);
+        return (entry != nullptr && now < entry->expires) ? entry : nullptr;
+    }
+
+    void place(size_t slot, Deadline&& deadline) {
+        deadline.entry->slot = slot;
+        heap[slot] = std::move(deadline);
+    }
+
+    // Восстановление кучи после изменения срока в позиции slot.
+    void sift(size_t slot);
+
+    // Удаление срока из кучи.
+    void erase_slot(size_t slot);
+
+public:
+    /**
+     * \brief Конструктор.
+     * \param alpha Коэффициент сбалансированности дерева ключей (см. BST::enable_scapegoat),
+     * 0 - без балансировки (для случайных ключей). Для монотонных ключей балансировка нужна.
+     * \post Дерево пустое.
+    */
+    explicit Expiring_BST(double alpha = 0) : tree(std::make_unique<Tree>()) {
+        tree->enable_scapegoat(alpha);
+    }
+
+    // Копия дерева содержит новые узлы, а куча указывает на узлы исходного дерева.
+    Expiring_BST(const Expiring_BST& other) = delete;
+    Expiring_BST& operator=(const Expiring_BST& other) = delete;
+
+    /**
+     * \brief Конструктор перемещения. Памяти не выделяет.
+     * \post other остаётся без дерева ключей: его можно только уничтожить
+     * или присвоить ему другой контейнер (после этого он снова пригоден к работе).
+    */
+    Expiring_BST(Expiring_BST&& other) noexcept : tree(std::move(other.tree)), heap(std::move(other.heap)) {}
+
+    /**
+     * \brief Присваивание перемещением: содержимое контейнеров обменивается.
+     * \post other получает прежнее содержимое и настройки этого контейнера.
+    */
+    Expiring_BST& operator=(Expiring_BST&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void swap(Expiring_BST& other) noexcept {
+        std::swap(tree, other.tree);
+        std::swap(heap, other.heap);
+    }
+
+    /**
+     * \brief Вставка элемента со сроком жизни.
+     * \param key Ключ для вставки.
+     * \param data Данные для вставки.
+     * \param expires Момент, начиная с которого элемент считается просроченным.
+     * \param now Текущий момент.
+     * \return true, если элемент вставлен; false, если живой элемент с таким ключом уже есть.
+     * \post Просроченный, но ещё не удалённый элемент с тем же ключом заменяется.
+    */
+    bool insert(const Key& key, const Data& data, Time expires, Time now);
+
+    /**
+     * \brief Продление срока жизни живого элемента.
+     * \param key Ключ элемента.
+     * \param expires Новый момент истечения.
+     * \param now Текущий момент.
+     * \return true, если элемент найден и не просрочен, иначе false.
+    */
+    bool touch(const Key& key, Time expires, Time now);
+
+    /**
+     * \brief Поиск живого элемента с заданным ключом.
+     * \param key Ключ для поиска.
+     * \param now Текущий момент.
+     * \return Ссылка на найденный элемент.
+     * \throw Array_exception если элемента нет или он просрочен.
+    */
+    Data& at(const Key& key, Time now) {
+        Entry* entry = live_entry(key, now);
+        if (entry == nullptr) {
+            throw Array_exception("No such key in Expiring_BST");
+        }
+        return entry->data;
+    }
+
+    /**
+     * \brief Проверка наличия живого элемента с заданным ключом.
+     * \param key Ключ для поиска.
+     * \param now Текущий момент.
+     * \return true, если элемент есть и не просрочен, иначе false.
+    */
+    bool contains(const Key& key, Time now) { return live_entry(key, now) != nullptr; }
+
+    /**
+     * \brief Удаление элемента с заданным ключом (живого или просроченного).
+     * \param key Ключ для удаления.
+     * \return true, если элемент был удалён, иначе false.
+    */
+    bool remove(const Key& key);
+
+    /**
+     * \brief Удаление просроченных элементов порцией ограниченного размера.
+     * \param now Текущий момент: удаляются элементы с expires <= now.
+     * \param batch Наибольшее число удаляемых за вызов элементов.
+     * \return Число удалённых элементов; меньше batch, если просроченных больше нет.
+     * \post Время O(k log n), где k - число удалённых элементов.
+    */
+    size_t expire_until(Time now, size_t batch = std::numeric_limits<size_t>::max());
+
+    /**
+     * \brief Число хранимых элементов, включая просроченные, но ещё не удалённые.
+    */
+    size_t get_size() const { return tree->get_size(); }
+
+    bool is_empty() const { return tree->is_empty(); }
+
+    /**
+     * \brief Список ключей живых элементов по возрастанию.
+     * \param now Текущий момент.
+    */
+    std::vector<Key> get_keys(Time now) const;
+};
+
+template <typename Key, typename Data, typename Time>
+void Expiring_BST<Key, Data, Time>::sift(size_t slot) {
+    Deadline moving = std::move(heap[slot]);
+
+    while (slot > 0 && moving.expires < heap[(slot - 1) / 2].expires) { // вверх
+        size_t parent = (slot - 1) / 2;
+        place(slot, std::move(heap[parent]));
+        slot = parent;
+    }
+
+    while (2 * slot + 1 < heap.size()) { // вниз
+        size_t child = 2 * slot + 1;
+        if (child + 1 < heap.size() && heap[child + 1].expires < heap[child].expires) {
+            ++child;
+        }
+        if (!(heap[child].expires < moving.expires)) {
+            break;
+        }
+        place(slot, std::move(heap[child]));
+        slot = child;
+    }
+
+    place(slot, std::move(moving));
+}
+
+template <typename Key, typename Data, typename Time>
+void Expiring_BST<Key, Data, Time>::erase_slot(size_t slot) {
+    if (slot + 1 < heap.size()) { // на место удалённого встаёт последний срок
+        place(slot, std::move(heap.back()));
+        heap.pop_back();
+        sift(slot);
+    } else {
+        heap.pop_back();
+    }
+}
+
+template <typename Key, typename Data, typename Time>
+bool Expiring_BST<Key, Data, Time>::insert(const Key& key, const Data& data, Time expires, Time now) {
+    Entry* entry = tree->find(key);
+    if (entry == nullptr) {
+        tree->insert(key, Entry{ data, expires, heap.size() });
+        heap.push_back(Deadline{ expires, key, tree->find(key) });
+        sift(heap.size() - 1);
+        return true;
+    }
+
+    if (now < entry->expires) { // дубликаты живых элементов запрещены
+        return false;
+    }
+
+    entry->data = data;
+    entry->expires = expires;
+    heap[entry->slot].expires = expires;
+    sift(entry->slot);
+    return true;
+}
+
+template <typename Key, typename Data, typename Time>
+bool Expiring_BST<Key, Data, Time>::touch(const Key& key, Time expires, Time now) {
+    Entry* entry = live_entry(key, now);
+    if (entry == nullptr) {
+        return false;
+    }
+
+    entry->expires = expires;
+    heap[entry->slot].expires = expires;
+    sift(entry->slot);
+    return true;
+}
+
+template <typename Key, typename Data, typename Time>
+bool Expiring_BST<Key, Data, Time>::remove(const Key& key) {
+    Entry* entry = tree->find(key);
+    if (entry == nullptr) {
+        return false;
+    }
+
+    erase_slot(entry->slot);
+    tree->remove(key);
+    return true;
+}
+
+template <typename Key, typename Data, typename Time>
+size_t Expiring_BST<Key, Data, Time>::expire_until(Time now, size_t batch) {
+    size_t removed = 0;
+
+    while (removed < batch && !heap.empty() && !(now < heap.front().expires)) {
+        Key key = heap.front().key; // элемент, истекающий раньше всех
+        erase_slot(0);
+        tree->remove(key);
+        ++removed;
+    }
+
+    return removed;
+}
+
+template <typename Key, typename Data, typename Time>
+std::vector<Key> Expiring_BST<Key, Data, Time>::get_keys(Time now) const {
+    std::vector<Key> keys;
+    tree->visit_in_order([&keys, now](const Key& key, const Entry& entry) {
+        if (now < entry.expires) {
+            keys.push_back(key);
+        }
+    });
+    return keys;
+}
+
+#endif
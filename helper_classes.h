@@ -9,7 +9,11 @@
 #include <cstddef> // for std::size_t
 #include <numeric> // for std::iota
 #include <string>
+#include <string_view>
 #include <limits>
+#include <ostream>
+#include <charconv> // for std::to_chars
+#include <type_traits>
 
 class Random {
 private:
@@ -36,4 +40,126 @@ public:
     }
 };
 
+/**
+ * \brief Буферизованный вывод в произвольный поток.
+ *
+ * Текст накапливается во внутреннем массиве фиксированного размера и передаётся
+ * в поток крупными блоками. Числа форматируются через std::to_chars без выделения памяти.
+*/
+class Buffered_writer {
+private:
+    static constexpr size_t capacity = 1 << 14;
+
+    std::ostream& out;
+    char buffer[capacity];
+    size_t used = 0;
+
+public:
+    explicit Buffered_writer(std::ostream& stream) : out(stream) {}
+
+    Buffered_writer(const Buffered_writer&) = delete;
+    Buffered_writer& operator=(const Buffered_writer&) = delete;
+
+    ~Buffered_writer() { flush(); }
+
+    void flush() {
+        if (used > 0) {
+            out.write(buffer, static_cast<std::streamsize>(used));
+            used = 0;
+        }
+    }
+
+    void put(char c) {
+        if (used == capacity) {
+            flush();
+        }
+        buffer[used++] = c;
+    }
+
+    void write(std::string_view text) {
+        if (text.size() > capacity - used) {
+            flush();
+            if (text.size() > capacity) {
+                out.write(text.data(), static_cast<std::streamsize>(text.size()));
+                return;
+            }
+        }
+        text.copy(buffer + used, text.size());
+        used += text.size();
+    }
+
+    void indent(size_t count, std::string_view unit = "  ") {
+        for (size_t i = 0; i < count; ++i) {
+            write(unit);
+        }
+    }
+
+    /**
+     * \brief Вывод текста с экранированием кавычек, обратной косой черты и управляющих символов.
+    */
+    void write_escaped(std::string_view text) {
+        static const char hex[] = "0123456789abcdef";
+        for (char c : text) {
+            unsigned char code = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                put('\\');
+                put(c);
+            } else if (c == '\n') {
+                write("\\n");
+            } else if (code < 0x20) {
+                write("\\u00");
+                put(hex[code >> 4]);
+                put(hex[code & 0xF]);
+            } else {
+                put(c);
+            }
+        }
+    }
+
+    /**
+     * \brief Вывод значения: числа и строки пишутся напрямую, остальные типы - через operator<<.
+    */
+    template<typename T>
+    void write_value(const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            write(value ? "true" : "false");
+        } else if constexpr (std::is_same_v<T, char>) {
+            put(value);
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            if (capacity - used < 64) {
+                flush();
+            }
+            std::to_chars_result result = std::to_chars(buffer + used, buffer + capacity, value);
+            used = static_cast<size_t>(result.ptr - buffer);
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            write(std::string_view(value));
+        } else {
+            flush();
+            out << value;
+        }
+    }
+
+    /**
+     * \brief Вывод значения в том же виде, что и operator<< потока с настройками по умолчанию:
+     * bool как 0/1, signed/unsigned char как символ, вещественные числа с 6 значащими цифрами.
+    */
+    template<typename T>
+    void write_as_stream(const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            put(value ? '1' : '0');
+        } else if constexpr (std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>) {
+            put(static_cast<char>(value));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            if (capacity - used < 64) {
+                flush();
+            }
+            std::to_chars_result result = std::to_chars(buffer + used, buffer + capacity, value,
+                                                        std::chars_format::general, 6); // как %g
+            used = static_cast<size_t>(result.ptr - buffer);
+        } else {
+            write_value(value);
+        }
+    }
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,367 @@
+#ifndef MULTI_TREE_H
+#define MULTI_TREE_H
+
+#include <vector>
+#include <stack>
+#include <new>     // for ::operator new
+#include <cstdint>
+#include <utility> // for std::pair, std::move
+#include "array_exception.h"
+
+/**
+ * \brief Дерево бинарного поиска с повторяющимися ключами (мультиотображение).
+ *
+ * Все значения одного ключа хранятся непрерывным массивом в том же блоке памяти,
+ * что и узел, поэтому ключ с одним значением стоит одно выделение памяти.
+ * При заполнении массива узел перевыделяется с удвоенной ёмкостью.
+*/
+template<typename Key, typename Data>
+class Multi_BST {
+private:
+    struct Node {
+        Key key;
+        Node* left;
+        Node* right;
+        uint32_t count;    // число значений ключа
+        uint32_t capacity; // под сколько значений выделена память
+
+        Node(const Key& k, uint32_t cap) : key(k), left(nullptr), right(nullptr), count(0), capacity(cap) {}
+
+        Data* values();
+    };
+
+    // значения располагаются сразу за узлом с учётом выравнивания Data
+    static constexpr size_t values_offset = (sizeof(Node) + alignof(Data) - 1) / alignof(Data) * alignof(Data);
+
+    static_assert(alignof(Data) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Data alignment is not supported");
+
+    Node* root;
+    size_t size;      // число значений
+    size_t key_count; // число различных ключей
+
+    static Node* create_node(const Key& key, uint32_t capacity);
+
+    static void destroy_node(Node* node);
+
+    // Перевыделение узла с удвоенной ёмкостью и добавление значения в конец массива;
+    // link - указатель на узел у родителя. При исключении узел остаётся прежним.
+    static void grow(Node*& link, const Data& data);
+
+    Node* find_node(const Key& key) const;
+
+public:
+    /**
+     * \brief Конструктор по умолчанию.
+     * \post Дерево пустое.
+    */
+    Multi_BST() : root(nullptr), size(0), key_count(0) {}
+
+    Multi_BST(const Multi_BST& other) = delete;
+    Multi_BST& operator=(const Multi_BST& other) = delete;
+
+    /**
+     * \brief Деструктор.
+     * \post Дерево освобождено.
+    */
+    ~Multi_BST() {
+        clear();
+    }
+
+    /**
+     * \brief Получение числа значений в дереве.
+     * \post Дерево остаётся неизменным.
+    */
+    size_t get_size() const { return size; }
+
+    /**
+     * \brief Получение числа различных ключей в дереве.
+     * \post Дерево остаётся неизменным.
+    */
+    size_t get_key_count() const { return key_count; }
+
+    /**
+     * \brief Проверка дерева на пустоту.
+     * \post Дерево остаётся неизменным.
+    */
+    bool is_empty() const { return size == 0; }
+
+    /**
+     * \brief Очистка дерева.
+     * \post Дерево пустое.
+    */
+    void clear();
+
+    /**
+     * \brief Вставляет значение с заданным ключом (ключ может уже быть в дереве).
+     * \param key Ключ для вставки.
+     * \param data Данные для вставки.
+     * \post Размер дерева увеличивается на 1. Значение добавлено после уже имеющихся значений ключа.
+    */
+    void insert(const Key& key, const Data& data);
+
+    /**
+     * \brief Число значений с заданным ключом.
+     * \post Дерево остаётся неизменным.
+    */
+    size_t count(const Key& key) const;
+
+    /**
+     * \brief Диапазон значений с заданным ключом.
+     * \return Пара указателей [first, last) на значения в порядке вставки; пустой диапазон, если ключа нет.
+     * Указатели действительны до следующего изменения дерева.
+    */
+    std::pair<Data*, Data*> equal_range(const Key& key);
+
+    /**
+     * \brief Диапазон значений с заданным ключом (константная версия).
+    */
+    std::pair<const Data*, const Data*> equal_range(const Key& key) const;
+
+    /**
+     * \brief Удаляет все значения с заданным ключом.
+     * \param key Ключ для удаления.
+     * \return Число удалённых значений.
+    */
+    size_t erase(const Key& key);
+
+    /**
+     * \brief Формирование списка различных ключей в порядке возрастания.
+     * \post Дерево остаётся неизменным.
+    */
+    std::vector<Key> get_keys() const;
+};
+
+template <typename Key, typename Data>
+Data* Multi_BST<Key, Data>::Node::values() {
+    return reinterpret_cast<Data*>(reinterpret_cast<char*>(this) + values_offset);
+}
+
+template <typename Key, typename Data>
+typename Multi_BST<Key, Data>::Node* Multi_BST<Key, Data>::create_node(const Key& key, uint32_t capacity) {
+    void* memory = ::operator new(values_offset + capacity * sizeof(Data));
+    try {
+        return new (memory) Node(key, capacity);
+    } catch (...) {
+        ::operator delete(memory);
+        throw;
+    }
+}
+
+template <typename Key, typename Data>
+void Multi_BST<Key, Data>::destroy_node(Node* node) {
+    Data* values = node->values();
+    for (uint32_t i = 0; i < node->count; ++i) {
+        values[i].~Data();
+    }
+
+    node->~Node();
+    ::operator delete(node);
+}
+
+template <typename Key, typename Data>
+void Multi_BST<Key, Data>::grow(Node*& link, const Data& data) {
+    Node* old_node = link;
+    Node* new_node = create_node(old_node->key, old_node->capacity * 2);
+
+    Data* from = old_node->values();
+    Data* to = new_node->values();
+    uint32_t count = old_node->count;
+    uint32_t constructed = 0;
+    bool appended = false;
+    try {
+        // data может ссылаться на значение старого узла, поэтому копируется до переноса
+        new (to + count) Data(data);
+        appended = true;
+
+        for (; constructed < count; ++constructed) {
+            new (to + constructed) Data(std::move_if_noexcept(from[constructed]));
+        }
+    } catch (...) {
+        for (uint32_t i = 0; i < constructed; ++i) {
+            to[i].~Data();
+        }
+        if (appended) {
+            to[count].~Data();
+        }
+        destroy_node(new_node); // count нового узла равен 0, значения уже уничтожены
+        throw;
+    }
+
+    new_node->count = count + 1;
+    new_node->left = old_node->left;
+    new_node->right = old_node->right;
+
+    destroy_node(old_node);
+    link = new_node;
+}
+
+template <typename Key, typename Data>
+void Multi_BST<Key, Data>::insert(const Key& key, const Data& data) {
+    Node** link = &root;
+
+    while (*link != nullptr && (*link)->key != key) { // ищем узел ключа или место вставки
+        if (key < (*link)->key) {
+            link = &(*link)->left;
+        } else {
+            link = &(*link)->right;
+        }
+    }
+
+    if (*link == nullptr) {
+        Node* node = create_node(key, 1);
+        try {
+            new (node->values()) Data(data);
+        } catch (...) {
+            destroy_node(node);
+            throw;
+        }
+        node->count = 1;
+        *link = node;
+        ++key_count;
+    } else if ((*link)->count == (*link)->capacity) {
+        grow(*link, data);
+    } else {
+        Node* node = *link;
+        new (node->values() + node->count) Data(data);
+        ++node->count;
+    }
+
+    ++size;
+}
+
+template <typename Key, typename Data>
+typename Multi_BST<Key, Data>::Node* Multi_BST<Key, Data>::find_node(const Key& key) const {
+    Node* current = root;
+
+    while (current != nullptr && current->key != key) {
+        if (key < current->key) {
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+
+    return current;
+}
+
+template <typename Key, typename Data>
+size_t Multi_BST<Key, Data>::count(const Key& key) const {
+    Node* node = find_node(key);
+    return node == nullptr ? 0 : node->count;
+}
+
+template <typename Key, typename Data>
+std::pair<Data*, Data*> Multi_BST<Key, Data>::equal_range(const Key& key) {
+    Node* node = find_node(key);
+    if (node == nullptr) {
+        return std::make_pair(nullptr, nullptr);
+    }
+
+    return std::make_pair(node->values(), node->values() + node->count);
+}
+
+template <typename Key, typename Data>
+std::pair<const Data*, const Data*> Multi_BST<Key, Data>::equal_range(const Key& key) const {
+    Node* node = find_node(key);
+    if (node == nullptr) {
+        return std::make_pair(nullptr, nullptr);
+    }
+
+    return std::make_pair(node->values(), node->values() + node->count);
+}
+
+template <typename Key, typename Data>
+size_t Multi_BST<Key, Data>::erase(const Key& key) {
+    Node** link = &root;
+
+    while (*link != nullptr && (*link)->key != key) { // поиск удаляемого узла
+        if (key < (*link)->key) {
+            link = &(*link)->left;
+        } else {
+            link = &(*link)->right;
+        }
+    }
+
+    Node* current = *link;
+    if (current == nullptr) { // элемента с заданным ключом не существует
+        return 0;
+    }
+
+    if (current->left == nullptr) {
+        *link = current->right;
+    } else if (current->right == nullptr) {
+        *link = current->left;
+    } else {
+        // узлы разного размера, поэтому приемник не копируется, а переносится на место удаляемого узла
+        Node** successor_link = &current->right;
+        while ((*successor_link)->left != nullptr) {
+            successor_link = &(*successor_link)->left;
+        }
+
+        Node* successor = *successor_link;
+        *successor_link = successor->right;
+
+        successor->left = current->left;
+        successor->right = current->right;
+        *link = successor;
+    }
+
+    size_t removed = current->count;
+    size -= removed;
+    --key_count;
+    destroy_node(current);
+
+    return removed;
+}
+
+template <typename Key, typename Data>
+void Multi_BST<Key, Data>::clear() {
+    if (root == nullptr) {
+        return;
+    }
+
+    std::stack<Node*> node_stack;
+    node_stack.push(root);
+
+    while (!node_stack.empty()) {
+        Node* current = node_stack.top();
+        node_stack.pop();
+
+        if (current->left != nullptr) {
+            node_stack.push(current->left);
+        }
+        if (current->right != nullptr) {
+            node_stack.push(current->right);
+        }
+
+        destroy_node(current);
+    }
+
+    root = nullptr;
+    size = 0;
+    key_count = 0;
+}
+
+template <typename Key, typename Data>
+std::vector<Key> Multi_BST<Key, Data>::get_keys() const {
+    std::vector<Key> keys;
+
+    std::stack<Node*> parent_stack;
+    Node* current = root;
+
+    while (!parent_stack.empty() || current != nullptr) {
+        if (current != nullptr) {
+            parent_stack.push(current);
+            current = current->left;
+        } else {
+            current = parent_stack.top();
+            parent_stack.pop();
+            keys.push_back(current->key);
+            current = current->right;
+        }
+    }
+
+    return keys;
+}
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+#include <vector>
+#include <new>     // for ::operator new
+#include <utility> // for std::forward
+
+/**
+ * \brief Блочный распределитель узлов дерева.
+ *
+ * Узлы выделяются подряд из крупных блоков, освобождённые места переиспользуются
+ * через список свободных мест. Для уплотнения дерева распределитель начинает новое
+ * поколение блоков: новые узлы (и перенесённые) идут только в него, а старые блоки
+ * освобождаются целиком, когда в них не осталось живых узлов.
+*/
+template<typename T>
+class Node_arena {
+private:
+    static_assert(sizeof(T) >= sizeof(void*), "Slot must fit a free list link");
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Node alignment is not supported");
+
+    struct Chunk {
+        T* slots;
+        size_t capacity;
+    };
+
+    struct Free_slot {
+        Free_slot* next;
+    };
+
+    // Блоки растут вдвое до этого размера: недозаполненный последний блок не раздувает память.
+    static constexpr size_t max_chunk_capacity = 4096;
+
+    std::vector<Chunk> chunks;  // текущее поколение
+    std::vector<Chunk> retired; // предыдущие поколения, ждущие освобождения
+    Free_slot* free_list = nullptr;
+    size_t used = 0;            // занято мест в последнем блоке
+    size_t next_capacity = 64;  // размер следующего блока
+    size_t live = 0;
+
+    void add_chunk(size_t capacity) {
+        T* slots = static_cast<T*>(::operator new(capacity * sizeof(T)));
+        chunks.push_back(Chunk{ slots, capacity });
+        used = 0;
+    }
+
+    static void release(std::vector<Chunk>& list) {
+        for (Chunk& chunk : list) {
+            ::operator delete(chunk.slots);
+        }
+        list.clear();
+    }
+
+public:
+    Node_arena() = default;
+    Node_arena(const Node_arena&) = delete;
+    Node_arena& operator=(const Node_arena&) = delete;
+
+    /**
+     * \brief Деструктор. Все узлы должны быть уничтожены заранее.
+    */
+    ~Node_arena() {
+        release(chunks);
+        release(retired);
+    }
+
+    template<typename... Args>
+    T* create(Args&&... args) {
+        void* memory;
+        if (free_list != nullptr) {
+            memory = free_list;
+            free_list = free_list->next;
+        } else {
+            if (chunks.empty() || used == chunks.back().capacity) {
+                add_chunk(next_capacity);
+                if (next_capacity < max_chunk_capacity) {
+                    next_capacity *= 2;
+                }
+            }
+            memory = chunks.back().slots + used++;
+        }
+
+        T* object = new (memory) T(std::forward<Args>(args)...);
+        ++live;
+        return object;
+    }
+
+    void destroy(T* object) {
+        object->~T();
+        --live;
+
+        // места старых поколений не переиспользуются: их блоки скоро будут освобождены
+        if (retired.empty() || owns(object)) {
+            Free_slot* slot = reinterpret_cast<Free_slot*>(object);
+            slot->next = free_list;
+            free_list = slot;
+        }
+    }
+
+    /**
+     * \brief Принадлежит ли место текущему поколению.
+     * Сразу после begin_generation() поколение состоит из одного блока, поэтому проверка быстрая.
+    */
+    bool owns(const T* object) const {
+        for (const Chunk& chunk : chunks) {
+            if (object >= chunk.slots && object < chunk.slots + chunk.capacity) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * \brief Начало нового поколения с одним блоком на capacity узлов.
+     * \post Старые блоки ждут release_retired(), новые узлы выделяются подряд в новом блоке.
+    */
+    void begin_generation(size_t capacity) {
+        retired.insert(retired.end(), chunks.begin(), chunks.end());
+        chunks.clear();
+        free_list = nullptr;
+
+        add_chunk(capacity == 0 ? 1 : capacity);
+        next_capacity = max_chunk_capacity;
+    }
+
+    /**
+     * \brief Освобождение блоков старых поколений.
+     * \pre Ни один живой узел не размещён в старых поколениях.
+    */
+    void release_retired() {
+        release(retired);
+    }
+
+    /**
+     * \brief Освобождение всех блоков.
+     * \pre Все узлы уничтожены.
+    */
+    void release_all() {
+        release(chunks);
+        release(retired);
+        free_list = nullptr;
+        used = 0;
+        next_capacity = 64;
+    }
+
+    /**
+     * \brief Объём памяти всех блоков в байтах.
+    */
+    size_t get_memory() const {
+        size_t bytes = 0;
+        for (const Chunk& chunk : chunks) {
+            bytes += chunk.capacity * sizeof(T);
+        }
+        for (const Chunk& chunk : retired) {
+            bytes += chunk.capacity * sizeof(T);
+        }
+        return bytes;
+    }
+
+    size_t get_live() const { return live; }
+};
+
+#endif
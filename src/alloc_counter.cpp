@@ -0,0 +1,37 @@
+#include <cstdlib>
+#include <new>
+#include <malloc.h> // for malloc_usable_size
+
+#include "alloc_counter.h"
+
+static Alloc_stats stats = { 0, 0, 0 };
+
+Alloc_stats get_alloc_stats() {
+    return stats;
+}
+
+void* operator new(std::size_t size) {
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    ++stats.allocations;
+    ++stats.live_blocks;
+    stats.live_bytes += malloc_usable_size(memory);
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    if (memory == nullptr) {
+        return;
+    }
+
+    --stats.live_blocks;
+    stats.live_bytes -= malloc_usable_size(memory);
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    operator delete(memory);
+}
@@ -0,0 +1,15 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+
+// Счётчики глобального operator new/delete (подключаются к замерам и к тестам).
+struct Alloc_stats {
+    size_t allocations; // число вызовов operator new
+    size_t live_blocks; // число неосвобождённых блоков
+    size_t live_bytes;  // занятая ими память с учётом округления аллокатора
+};
+
+Alloc_stats get_alloc_stats();
+
+#endif
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "../tree.h"
+#include "../art.h"
+#include "../helper_classes.h"
+#include "alloc_counter.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+// Пути в духе URL и файловой системы: длинные общие префиксы, разная глубина.
+static std::vector<std::string> make_paths(size_t count, Random& random) {
+    static const char* const roots[] = { "/api/v1/users/", "/api/v2/orders/", "/static/js/", "/home/",
+                                         "https://example.com/catalog/", "/var/log/service-" };
+    static const char* const words[] = { "items", "profile", "settings", "src", "include", "build", "assets",
+                                         "index", "detail", "archive" };
+
+    std::vector<std::string> paths;
+    paths.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string path = roots[random.get_int(0, 5)];
+        path += std::to_string(random.get_int(0, 99999));
+        int depth = random.get_int(0, 3);
+        for (int d = 0; d < depth; ++d) {
+            path += '/';
+            path += words[random.get_int(0, 9)];
+        }
+        if (random.get_int(0, 1) == 1) {
+            path += "/" + std::to_string(random.get_int(0, 999)) + ".html";
+        }
+        paths.push_back(std::move(path));
+    }
+    return paths;
+}
+
+template<typename Tree>
+static void measure(const char* name, const std::vector<std::string>& paths, const std::vector<std::string>& lookups) {
+    Alloc_stats before = get_alloc_stats();
+    Tree tree;
+
+    double insert_time = 0;
+    {
+        // время читается до деструктора region, который печатает счётчики
+        Perf_region region(std::string(name) + " insert", paths.size());
+        Timer timer;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            tree.insert(paths[i], static_cast<int>(i));
+        }
+        insert_time = timer.elapsed();
+    }
+    Alloc_stats after = get_alloc_stats();
+
+    long long checksum = 0;
+    double lookup_time = 0;
+    {
+        Perf_region region(std::string(name) + " at", lookups.size());
+        Timer timer;
+        for (const std::string& path : lookups) {
+            checksum += tree.at(path);
+        }
+        lookup_time = timer.elapsed();
+    }
+    if (checksum == 42) {
+        std::cout << "";
+    }
+
+    std::cout << "  " << name << ": insert " << insert_time << " s, lookup " << lookup_time << " s ("
+              << lookup_time / lookups.size() * 1e9 << " ns/op), "
+              << static_cast<double>(after.live_bytes - before.live_bytes) / tree.get_size() << " bytes/key"
+              << std::endl;
+}
+
+void bench_art() {
+    Random random;
+
+    for (size_t count : { 100000, 1000000 }) {
+        std::vector<std::string> paths = make_paths(count, random);
+        std::vector<std::string> lookups;
+        for (size_t i = 0; i < 1000000; ++i) {
+            lookups.push_back(paths[random.get_int(0, static_cast<int>(paths.size()) - 1)]);
+        }
+
+        std::cout << count << " path keys" << std::endl;
+        measure<BST<std::string, int>>("BST<std::string, int>", paths, lookups);
+        measure<ART<int>>("ART<int>             ", paths, lookups);
+    }
+}
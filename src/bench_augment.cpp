@@ -0,0 +1,98 @@
+#include <iostream>
+#include <vector>
+
+#include "../tree.h"
+#include "../helper_classes.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+using Sum_tree = BST<int, long long, Sum_augmentation<int, long long>>;
+
+// Сумма по диапазону так, как её считали раньше: полный обход списка ключей.
+static long long scan_sum(BST<int, long long>& tree, int lo, int hi) {
+    long long sum = 0;
+    for (int key : tree.get_keys()) {
+        if (key >= lo && key <= hi) {
+            sum += tree.at(key);
+        }
+    }
+    return sum;
+}
+
+void bench_augment() {
+    Random random;
+    const int count = 200000;
+    const int scan_queries = 50;
+    const int aggregate_queries = 1000000;
+
+    std::vector<int> keys;
+    for (int i = 0; i < count; ++i) {
+        keys.push_back(random.get_int(0, 1 << 30));
+    }
+
+    std::vector<std::pair<int, int>> ranges;
+    for (int i = 0; i < aggregate_queries; ++i) {
+        int lo = random.get_int(0, 1 << 30);
+        ranges.emplace_back(lo, lo + random.get_int(0, 1 << 24));
+    }
+
+    // время читается до деструктора region, который печатает счётчики
+    BST<int, long long> plain;
+    double plain_insert = 0;
+    {
+        Perf_region region("plain insert", keys.size());
+        Timer timer;
+        for (int key : keys) {
+            plain.insert(key, key % 1000);
+        }
+        plain_insert = timer.elapsed();
+    }
+
+    Sum_tree augmented;
+    double augmented_insert = 0;
+    {
+        Perf_region region("Sum_augmentation insert", keys.size());
+        Timer timer;
+        for (int key : keys) {
+            augmented.insert(key, key % 1000);
+        }
+        augmented_insert = timer.elapsed();
+    }
+
+    long long checksum = 0;
+    double scan_time = 0;
+    {
+        Perf_region region("full scan query", scan_queries);
+        Timer timer;
+        for (int i = 0; i < scan_queries; ++i) {
+            checksum += scan_sum(plain, ranges[i].first, ranges[i].second);
+        }
+        scan_time = timer.elapsed() / scan_queries;
+    }
+
+    long long check = 0;
+    for (int i = 0; i < scan_queries; ++i) {
+        check += augmented.aggregate(ranges[i].first, ranges[i].second);
+    }
+    if (check != checksum) {
+        std::cout << "  aggregate mismatch: " << check << " != " << checksum << std::endl;
+    }
+
+    double aggregate_time = 0;
+    {
+        Perf_region region("aggregate query", ranges.size());
+        Timer timer;
+        for (const auto& [lo, hi] : ranges) {
+            checksum += augmented.aggregate(lo, hi);
+        }
+        aggregate_time = timer.elapsed() / aggregate_queries;
+    }
+
+    std::cout << count << " random keys" << std::endl;
+    std::cout << "  insert: plain " << plain_insert << " s, with Sum_augmentation " << augmented_insert << " s" << std::endl;
+    std::cout << "  range sum: full scan " << scan_time * 1e6 << " us/query, aggregate "
+              << aggregate_time * 1e9 << " ns/query" << std::endl;
+    if (checksum == 42) {
+        std::cout << "";
+    }
+}
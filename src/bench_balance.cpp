@@ -0,0 +1,96 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <string>
+
+#include "../tree.h"
+#include "../helper_classes.h"
+#include "alloc_counter.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+struct Balance_result {
+    double insert_time;
+    double lookup_time;
+    double bytes_per_node;
+};
+
+template<typename Insert, typename Lookup>
+static Balance_result measure(const char* name, const std::vector<int>& keys, const std::vector<int>& lookups,
+                              Insert insert, Lookup lookup) {
+    Balance_result result;
+    Alloc_stats before = get_alloc_stats();
+
+    {
+        // время читается до деструктора region, который печатает счётчики
+        Perf_region region(std::string(name) + " insert", keys.size());
+        Timer timer;
+        for (int key : keys) {
+            insert(key);
+        }
+        result.insert_time = timer.elapsed();
+    }
+    result.bytes_per_node = static_cast<double>(get_alloc_stats().live_bytes - before.live_bytes) / keys.size();
+
+    long long checksum = 0;
+    {
+        Perf_region region(std::string(name) + " at", lookups.size());
+        Timer timer;
+        for (int key : lookups) {
+            checksum += lookup(key);
+        }
+        result.lookup_time = timer.elapsed();
+    }
+    if (checksum == 42) {
+        std::cout << "";
+    }
+
+    return result;
+}
+
+static void print_result(const char* name, const Balance_result& result) {
+    std::cout << "  " << name << ": insert " << result.insert_time << " s, lookup " << result.lookup_time
+              << " s, " << result.bytes_per_node << " bytes/node" << std::endl;
+}
+
+static void compare(const char* title, const std::vector<int>& keys, size_t lookup_count, Random& random) {
+    std::vector<int> lookups;
+    for (size_t i = 0; i < lookup_count; ++i) {
+        lookups.push_back(keys[random.get_int(0, static_cast<int>(keys.size()) - 1)]);
+    }
+    std::cout << title << std::endl;
+
+    {
+        BST<int, int> tree;
+        print_result("BST (unbalanced)  ", measure("BST (unbalanced)", keys, lookups,
+            [&tree](int key) { tree.insert(key, key); }, [&tree](int key) { return tree.at(key); }));
+    }
+    {
+        BST<int, int> tree;
+        tree.enable_scapegoat(0.7);
+        print_result("BST scapegoat 0.7 ", measure("BST scapegoat 0.7", keys, lookups,
+            [&tree](int key) { tree.insert(key, key); }, [&tree](int key) { return tree.at(key); }));
+        std::cout << "    height " << tree.analyze().height << std::endl;
+    }
+    {
+        std::map<int, int> tree; // красно-чёрное дерево
+        print_result("std::map (RB tree)", measure("std::map (RB tree)", keys, lookups,
+            [&tree](int key) { tree.emplace(key, key); }, [&tree](int key) { return tree.at(key); }));
+    }
+}
+
+void bench_balance() {
+    Random random;
+
+    std::vector<int> random_keys;
+    for (int i = 0; i < 1000000; ++i) {
+        random_keys.push_back(random.get_int(0, 1 << 30));
+    }
+    compare("1M random keys, 1M lookups", random_keys, 1000000, random);
+
+    std::vector<int> sorted_keys;
+    for (int i = 0; i < 30000; ++i) {
+        sorted_keys.push_back(i);
+    }
+    compare("30K sorted keys, 30K lookups", sorted_keys, 30000, random);
+}
@@ -0,0 +1,71 @@
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "../tree.h"
+#include "../buffered_tree.h"
+#include "../helper_classes.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+// Смешанная нагрузка: на каждые 10 операций 8 вставок случайных ключей, 1 удаление и 1 поиск.
+// Без mixed выполняются только вставки.
+template<typename Tree, typename Lookup>
+static double run_workload(const std::string& name, Tree& tree, const std::vector<int>& keys, Lookup lookup, bool mixed) {
+    long long found = 0;
+    double elapsed = 0;
+    {
+        // время читается до деструктора region, который печатает счётчики
+        Perf_region region(name + (mixed ? " mixed" : " insert"), keys.size());
+        Timer timer;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (mixed && i % 10 == 8) {
+                tree.remove(keys[i / 2]);
+            } else if (mixed && i % 10 == 9) {
+                found += lookup(tree, keys[i / 3]);
+            } else {
+                tree.insert(keys[i], keys[i]);
+            }
+        }
+        elapsed = timer.elapsed();
+    }
+    std::cout << (mixed ? "mixed " : "insert") << " (found " << found << ")";
+    return elapsed;
+}
+
+static void compare(const std::vector<int>& keys, bool mixed) {
+    BST<int, int> plain;
+    double plain_time = run_workload("unbuffered", plain, keys, [](BST<int, int>& t, int key) {
+        try {
+            t.at(key);
+            return 1;
+        } catch (const Array_exception&) {
+            return 0;
+        }
+    }, mixed);
+    std::cout << " unbuffered: " << plain_time << " s, size " << plain.get_size() << std::endl;
+
+    for (size_t buffer_size : { 8192, 65536, 262144 }) {
+        Buffered_BST<int, int> buffered(buffer_size);
+        double buffered_time = run_workload("buffered " + std::to_string(buffer_size), buffered, keys, [](Buffered_BST<int, int>& t, int key) {
+            return t.contains(key) ? 1 : 0;
+        }, mixed);
+        Timer timer;
+        size_t size = buffered.get_size(); // включая сброс остатка буфера
+        buffered_time += timer.elapsed();
+        std::cout << " buffered " << buffer_size << ": " << buffered_time << " s, size " << size << std::endl;
+    }
+}
+
+void bench_buffered_insert() {
+    const size_t operations = 2000000;
+
+    Random random;
+    std::vector<int> keys(operations);
+    for (int& key : keys) {
+        key = random.get_int(0, 1 << 30);
+    }
+
+    compare(keys, false);
+    compare(keys, true);
+}
@@ -0,0 +1,71 @@
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "../tree.h"
+#include "../helper_classes.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+// Трасса запросов: 90% обращений к небольшому набору "горячих" ключей.
+static std::vector<int> make_trace(const std::vector<int>& keys, size_t length, Random& random) {
+    const int hot_count = 256;
+    std::vector<int> trace;
+    trace.reserve(length);
+
+    for (size_t i = 0; i < length; ++i) {
+        if (random.get_int(1, 10) <= 9) {
+            trace.push_back(keys[random.get_int(0, hot_count - 1)]);
+        } else {
+            trace.push_back(keys[random.get_int(0, static_cast<int>(keys.size()) - 1)]);
+        }
+    }
+
+    return trace;
+}
+
+static double run_trace(const char* name, BST<int, int>& tree, const std::vector<int>& trace) {
+    long long checksum = 0;
+    double elapsed = 0;
+    {
+        // время читается до деструктора region, который печатает счётчики
+        Perf_region region(std::string(name) + " at", trace.size());
+        Timer timer;
+        for (int key : trace) {
+            checksum += tree.at(key);
+        }
+        elapsed = timer.elapsed();
+    }
+
+    if (checksum == 42) { // не даём компилятору выбросить цикл
+        std::cout << "";
+    }
+    return elapsed;
+}
+
+void bench_lookup_cache() {
+    const int tree_size = 200000;
+    const size_t trace_length = 2000000;
+
+    Random random;
+    BST<int, int> tree;
+    std::vector<int> keys;
+    while (static_cast<int>(keys.size()) < tree_size) {
+        int key = random.get_int(0, 1 << 30);
+        if (tree.insert(key, key)) {
+            keys.push_back(key);
+        }
+    }
+
+    std::vector<int> trace = make_trace(keys, trace_length, random);
+
+    double plain = run_trace("no cache", tree, trace);
+    std::cout << "no cache:    " << plain << " s" << std::endl;
+
+    for (size_t slots : { 256, 1024, 4096 }) {
+        tree.enable_cache(slots);
+        double cached = run_trace(("cache " + std::to_string(slots)).c_str(), tree, trace);
+        std::cout << "cache " << slots << ": " << cached << " s, hits " << tree.get_cache_hits()
+                  << ", misses " << tree.get_cache_misses() << std::endl;
+    }
+}
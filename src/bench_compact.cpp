@@ -0,0 +1,121 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <string>
+
+#include "../tree.h"
+#include "../helper_classes.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+// Дерево после долгой работы: узлы, вставленные на место удалённых, разбросаны по памяти.
+static void age(BST<int, int>& tree, std::vector<int>& keys, Random& random, int operations) {
+    for (int i = 0; i < operations; ++i) {
+        size_t victim = static_cast<size_t>(random.get_int(0, static_cast<int>(keys.size()) - 1));
+        tree.remove(keys[victim]);
+
+        int key = random.get_int(0, 1 << 30);
+        while (!tree.insert(key, key)) {
+            key = random.get_int(0, 1 << 30);
+        }
+        keys[victim] = key;
+    }
+}
+
+static void measure(const char* title, BST<int, int>& tree, const std::vector<int>& lookups) {
+    long long checksum = 0;
+    double lookup_time = 0;
+    {
+        // время читается до деструктора region, который печатает счётчики
+        Perf_region region(std::string(title) + " at", lookups.size());
+        Timer timer;
+        for (int key : lookups) {
+            checksum += tree.at(key);
+        }
+        lookup_time = timer.elapsed() / lookups.size();
+    }
+
+    std::vector<int> keys;
+    double scan_time = 0;
+    {
+        Perf_region region(std::string(title) + " scan", tree.get_size());
+        Timer timer;
+        keys = tree.get_keys(); // симметричный обход всего дерева
+        scan_time = timer.elapsed() / keys.size();
+    }
+    checksum += keys.back();
+
+    std::cout << "  " << title << ": lookup " << lookup_time * 1e9 << " ns, in-order scan " << scan_time * 1e9
+              << " ns/node, node memory " << tree.get_node_memory() / (1 << 20) << " MB" << std::endl;
+    if (checksum == 42) {
+        std::cout << "";
+    }
+}
+
+void bench_compact() {
+    const int count = 1000000;
+    const int churn = 3000000;
+    Random random;
+
+    BST<int, int> trees[2];
+    std::vector<int> keys[2];
+    for (int t = 0; t < 2; ++t) {
+        for (int i = 0; i < count; ++i) {
+            int key = random.get_int(0, 1 << 30);
+            if (trees[t].insert(key, key)) {
+                keys[t].push_back(key);
+            }
+        }
+    }
+
+    std::vector<int> lookups;
+    for (int i = 0; i < 1000000; ++i) {
+        lookups.push_back(keys[0][random.get_int(0, static_cast<int>(keys[0].size()) - 1)]);
+    }
+
+    std::cout << keys[0].size() << " keys, aged with " << churn << " remove+insert pairs" << std::endl;
+    measure("fresh               ", trees[0], lookups);
+    age(trees[0], keys[0], random, churn);
+
+    lookups.clear();
+    for (int i = 0; i < 1000000; ++i) {
+        lookups.push_back(keys[0][random.get_int(0, static_cast<int>(keys[0].size()) - 1)]);
+    }
+    measure("aged                ", trees[0], lookups);
+
+    Timer timer;
+    trees[0].compact(Compact_layout::breadth_first);
+    double bfs_time = timer.elapsed();
+    measure("compact breadth_first", trees[0], lookups);
+
+    timer.reset();
+    trees[0].compact(Compact_layout::in_order);
+    double in_order_time = timer.elapsed();
+    measure("compact in_order    ", trees[0], lookups);
+    std::cout << "  full compact: breadth_first " << bfs_time * 1e3 << " ms, in_order " << in_order_time * 1e3 << " ms" << std::endl;
+
+    // пошаговое уплотнение с изменениями между шагами
+    age(trees[1], keys[1], random, churn);
+    size_t steps = 0;
+    double longest_step = 0;
+    double total = 0;
+    bool done = false;
+    while (!done) {
+        timer.reset();
+        done = trees[1].compact_step(4096);
+        double step = timer.elapsed();
+        longest_step = std::max(longest_step, step);
+        total += step;
+        ++steps;
+
+        age(trees[1], keys[1], random, 16);
+    }
+    std::cout << "  compact_step(4096): " << steps << " steps, total " << total * 1e3 << " ms, longest step "
+              << longest_step * 1e6 << " us" << std::endl;
+
+    lookups.clear();
+    for (int i = 0; i < 1000000; ++i) {
+        lookups.push_back(keys[1][random.get_int(0, static_cast<int>(keys[1].size()) - 1)]);
+    }
+    measure("after compact_step  ", trees[1], lookups);
+}
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <filesystem>
+
+#include "../disk_btree.h"
+#include "../helper_classes.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+static std::string bench_file() {
+    std::string path = (std::filesystem::temp_directory_path() / "bench_disk_btree.db").string();
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".wal");
+    return path;
+}
+
+static void print_stats(const Disk_stats& stats) {
+    std::cout << "    pool hits " << stats.page_hits << ", misses " << stats.page_misses << ", evictions " << stats.evictions
+              << ", page writes " << stats.page_writes << ", commits " << stats.commits
+              << ", WAL " << stats.wal_bytes / (1 << 20) << " MB, checkpoints " << stats.checkpoints << std::endl;
+}
+
+// Групповая фиксация: одна синхронизация журнала на group операций.
+static void bench_group_commit(size_t group) {
+    std::string path = bench_file();
+    Random random;
+    const int count = 2000;
+
+    Disk_btree<int, int> tree(path, 1024, group);
+    double elapsed = 0;
+    {
+        // время читается до деструктора region, который печатает счётчики
+        Perf_region region("group_commit " + std::to_string(group) + " insert", count);
+        Timer timer;
+        for (int i = 0; i < count; ++i) {
+            tree.insert(random.get_int(0, 1 << 30), i);
+        }
+        tree.sync();
+        elapsed = timer.elapsed();
+    }
+
+    std::cout << "  group_commit " << group << ": " << elapsed / count * 1e6 << " us/insert, "
+              << tree.get_stats().commits << " fsyncs" << std::endl;
+}
+
+void bench_disk() {
+    const size_t pool_pages = 256; // 1 МБ
+    const int count = 1000000;
+    const int lookups = 200000;
+
+    std::string path = bench_file();
+    Random random;
+    std::vector<int> keys;
+    for (int i = 0; i < count; ++i) {
+        keys.push_back(random.get_int(0, 1 << 30));
+    }
+
+    {
+        Disk_btree<int, int> tree(path, pool_pages, 256);
+
+        double insert_time = 0;
+        {
+            Perf_region region("insert", keys.size());
+            Timer timer;
+            for (int key : keys) {
+                tree.insert(key, key / 2);
+            }
+            tree.sync();
+            insert_time = timer.elapsed();
+        }
+
+        std::filesystem::path file(path);
+        size_t file_pages = std::filesystem::file_size(file) / disk_page_size;
+        std::cout << tree.get_size() << " keys, " << file_pages << " pages on disk, pool " << pool_pages
+                  << " pages (working set " << file_pages / pool_pages << "x pool)" << std::endl;
+        std::cout << "  insert: " << insert_time << " s (" << insert_time / count * 1e6 << " us/op)" << std::endl;
+        print_stats(tree.get_stats());
+    }
+
+    // повторное открытие: пул пуст, все чтения идут с диска (через страничный кэш ОС)
+    Disk_btree<int, int> tree(path, pool_pages, 256);
+
+    long long checksum = 0;
+    double lookup_time = 0;
+    {
+        Perf_region region("random at", lookups);
+        Timer timer;
+        for (int i = 0; i < lookups; ++i) {
+            checksum += tree.at(keys[random.get_int(0, count - 1)]);
+        }
+        lookup_time = timer.elapsed();
+    }
+    std::cout << "  random lookup: " << lookup_time / lookups * 1e6 << " us/op" << std::endl;
+
+    size_t scanned = 0;
+    double scan_time = 0;
+    {
+        Perf_region region("ordered scan", tree.get_size());
+        Timer timer;
+        for (auto it = tree.begin(); it != tree.end(); ++it) {
+            checksum += it->second;
+            ++scanned;
+        }
+        scan_time = timer.elapsed();
+    }
+    std::cout << "  ordered scan: " << scanned << " entries in " << scan_time << " s ("
+              << scan_time / scanned * 1e9 << " ns/entry)" << std::endl;
+    print_stats(tree.get_stats());
+
+    if (checksum == 42) {
+        std::cout << "";
+    }
+
+    bench_group_commit(1);
+    bench_group_commit(64);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".wal");
+}
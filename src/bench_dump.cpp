@@ -0,0 +1,66 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+
+#include "../tree.h"
+#include "../helper_classes.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+static double time_dump(const std::string& name, const BST<int, int>& tree, std::ostream& out, const Dump_options& options) {
+    // время читается до деструктора region, который печатает счётчики
+    Perf_region region(name + " dump per node", tree.get_size());
+    Timer timer;
+    tree.dump(out, options);
+    return timer.elapsed();
+}
+
+void bench_dump() {
+    const int tree_size = 1000000;
+    const int chain_size = 20000;
+
+    Random random;
+    BST<int, int> tree;
+    while (static_cast<int>(tree.get_size()) < tree_size) {
+        int key = random.get_int(0, 1 << 30);
+        tree.insert(key, key);
+    }
+
+    std::ofstream sink("/dev/null");
+
+    // прежний способ вывода: строка на узел со сбросом потока после каждой строки
+    std::vector<int> keys = tree.get_keys();
+    double endl_time = 0;
+    {
+        Perf_region region("std::endl per node", keys.size());
+        Timer timer;
+        for (int key : keys) {
+            sink << key << " " << tree.at(key) << std::endl;
+        }
+        endl_time = timer.elapsed();
+    }
+    std::cout << "std::endl per node: " << endl_time << " s" << std::endl;
+
+    // замер до вывода строки: область счётчиков печатает свою строку
+    Dump_options options;
+    double text_time = time_dump("text", tree, sink, options);
+    std::cout << "text:               " << text_time << " s" << std::endl;
+    options.format = Dump_format::dot;
+    double dot_time = time_dump("dot", tree, sink, options);
+    std::cout << "dot:                " << dot_time << " s" << std::endl;
+    options.format = Dump_format::json;
+    double json_time = time_dump("json", tree, sink, options);
+    std::cout << "json:               " << json_time << " s" << std::endl;
+    options.format = Dump_format::text;
+    options.max_depth = 12;
+    double limited_time = time_dump("text, depth <= 12,", tree, sink, options);
+    std::cout << "text, depth <= 12:  " << limited_time << " s" << std::endl;
+
+    BST<int, int> chain;
+    for (int key = chain_size; key > 0; --key) {
+        chain.insert(key, key);
+    }
+    double chain_time = time_dump("chain text", chain, sink, Dump_options());
+    std::cout << "text, " << chain_size << "-node chain: " << chain_time << " s" << std::endl;
+}
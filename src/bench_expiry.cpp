@@ -0,0 +1,93 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "../tree.h"
+#include "../expiring_tree.h"
+#include "../helper_classes.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+// Сессионный индекс: за такт появляется одна сессия и выполняется один поиск,
+// сессия живёт ttl тактов, поэтому в индексе около ttl живых сессий.
+static const int tick_count = 1000000;
+static const uint64_t ttl = 200000;
+
+struct Session {
+    int data;
+    uint64_t expires;
+};
+
+static void print_pauses(const char* name, std::vector<double>& ticks, size_t stored) {
+    double total = 0;
+    for (double tick : ticks) {
+        total += tick;
+    }
+    std::sort(ticks.begin(), ticks.end());
+
+    // отдельные паузы в несколько миллисекунд бывают и от планировщика ОС, поэтому важны и квантили
+    std::cout << "  " << name << ": " << total / ticks.size() * 1e9 << " ns/tick, p99.9 "
+              << ticks[ticks.size() * 999 / 1000] * 1e6 << " us, p99.99 " << ticks[ticks.size() * 9999 / 10000] * 1e6
+              << " us, longest " << ticks.back() * 1e3 << " ms, stored " << stored << std::endl;
+}
+
+void bench_expiry() {
+    Random random;
+    std::vector<int> keys;
+    for (int i = 0; i < tick_count; ++i) {
+        keys.push_back(random.get_int(0, 1 << 30));
+    }
+
+    std::cout << tick_count << " ticks, ttl " << ttl << " ticks" << std::endl;
+    std::vector<double> ticks(tick_count);
+
+    {
+        // прежний способ: периодический просмотр get_keys() и remove для каждой устаревшей сессии
+        BST<int, Session> sessions;
+        long long checksum = 0;
+        {
+            Perf_region region("BST + periodic scan tick", tick_count);
+            for (int now = 0; now < tick_count; ++now) {
+                Timer timer;
+                sessions.insert(keys[now], Session{ now, now + ttl });
+                if (sessions.contains(keys[now / 2])) {
+                    checksum += sessions.at(keys[now / 2]).data;
+                }
+                if (now % 10000 == 0) {
+                    for (int key : sessions.get_keys()) {
+                        if (sessions.at(key).expires <= static_cast<uint64_t>(now)) {
+                            sessions.remove(key);
+                        }
+                    }
+                }
+                ticks[now] = timer.elapsed();
+            }
+        }
+        print_pauses("BST + periodic scan   ", ticks, sessions.get_size());
+        if (checksum == 42) {
+            std::cout << "";
+        }
+    }
+
+    {
+        Expiring_BST<int, int> sessions;
+        long long checksum = 0;
+        {
+            Perf_region region("Expiring_BST tick", tick_count);
+            for (int now = 0; now < tick_count; ++now) {
+                Timer timer;
+                sessions.insert(keys[now], now, now + ttl, now);
+                if (sessions.contains(keys[now / 2], now)) {
+                    checksum += sessions.at(keys[now / 2], now);
+                }
+                sessions.expire_until(now, 8); // порция больше темпа поступления: очистка не отстаёт
+                ticks[now] = timer.elapsed();
+            }
+        }
+        print_pauses("Expiring_BST, batch 8 ", ticks, sessions.get_size());
+        if (checksum == 42) {
+            std::cout << "";
+        }
+    }
+}
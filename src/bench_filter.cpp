@@ -0,0 +1,93 @@
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "../tree.h"
+#include "../helper_classes.h"
+#include "../array_exception.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+// Поиск через at(): промах стоит исключения, как в коде, который мы ускоряем.
+static double time_at(const std::string& name, BST<int, int>& tree, const std::vector<int>& lookups) {
+    long long checksum = 0;
+    double elapsed = 0;
+    {
+        // время читается до деструктора region, который печатает счётчики
+        Perf_region region(name + " at", lookups.size());
+        Timer timer;
+        for (int key : lookups) {
+            try {
+                checksum += tree.at(key);
+            } catch (const Array_exception&) {
+                --checksum;
+            }
+        }
+        elapsed = timer.elapsed();
+    }
+    if (checksum == 42) {
+        std::cout << "";
+    }
+    return elapsed / lookups.size() * 1e9;
+}
+
+static double time_contains(const std::string& name, BST<int, int>& tree, const std::vector<int>& lookups) {
+    size_t found = 0;
+    double elapsed = 0;
+    {
+        Perf_region region(name + " contains", lookups.size());
+        Timer timer;
+        for (int key : lookups) {
+            found += tree.contains(key) ? 1 : 0;
+        }
+        elapsed = timer.elapsed();
+    }
+    if (found == 42) {
+        std::cout << "";
+    }
+    return elapsed / lookups.size() * 1e9;
+}
+
+void bench_filter() {
+    Random random;
+    const int count = 1000000;
+    const int lookup_count = 1000000;
+
+    // чётные ключи есть в дереве, нечётные - нет
+    BST<int, int> plain;
+    BST<int, int> filtered;
+    filtered.enable_filter(count, 10);
+    for (int i = 0; i < count; ++i) {
+        int key = random.get_int(0, 1 << 29) * 2;
+        plain.insert(key, key);
+        filtered.insert(key, key);
+    }
+    std::vector<int> present = plain.get_keys();
+
+    std::cout << plain.get_size() << " keys, " << lookup_count << " lookups; ns/lookup" << std::endl;
+    std::cout << "  miss %   at() plain   at() filter   contains() plain   contains() filter" << std::endl;
+
+    for (int miss_percent : { 0, 25, 50, 75, 90, 99 }) {
+        std::vector<int> lookups;
+        for (int i = 0; i < lookup_count; ++i) {
+            if (random.get_int(0, 99) < miss_percent) {
+                lookups.push_back(random.get_int(0, 1 << 29) * 2 + 1);
+            } else {
+                lookups.push_back(present[random.get_int(0, static_cast<int>(present.size()) - 1)]);
+            }
+        }
+
+        // замеры до вывода строки таблицы: области счётчиков печатают свои строки
+        std::string miss = std::to_string(miss_percent) + "% miss";
+        double at_plain = time_at(miss + " plain", plain, lookups);
+        double at_filter = time_at(miss + " filter", filtered, lookups);
+        double contains_plain = time_contains(miss + " plain", plain, lookups);
+        double contains_filter = time_contains(miss + " filter", filtered, lookups);
+        std::cout << "  " << miss_percent << "\t   " << at_plain << "\t" << at_filter
+                  << "\t" << contains_plain << "\t\t" << contains_filter << std::endl;
+    }
+
+    Filter_stats stats = filtered.get_filter_stats();
+    std::cout << "  filter: " << stats.memory_bytes << " bytes (" << 8.0 * stats.memory_bytes / stats.keys
+              << " bits/key), estimated FPR " << stats.estimated_fpr << ", observed FPR " << stats.observed_fpr << std::endl;
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "../tree.h"
+#include "../helper_classes.h"
+#include "alloc_counter.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+using Shard = BST<int, std::string>;
+
+static void fill(Shard& shard, const std::vector<int>& keys) {
+    for (int key : keys) {
+        shard.insert(key, "session-payload-" + std::to_string(key)); // строка длиннее SSO: копия выделяет память
+    }
+}
+
+template<typename Move>
+static void measure(const char* name, const std::vector<int>& keys, bool shared, Move move) {
+    Shard from;
+    Shard to;
+    if (shared) {
+        to.share_node_arena(from);
+    }
+    fill(from, keys);
+
+    size_t allocations = 0;
+    size_t moved = 0;
+    double elapsed = 0;
+    {
+        // время и выделения читаются до деструктора region, который печатает счётчики;
+        // счётчики - на один ключ входного набора, а не на перенесённый элемент
+        Perf_region region(name, keys.size());
+        allocations = get_alloc_stats().allocations;
+        Timer timer;
+        moved = move(from, to);
+        elapsed = timer.elapsed();
+        allocations = get_alloc_stats().allocations - allocations;
+    }
+
+    std::cout << "  " << name << ": " << elapsed / moved * 1e9 << " ns/element, "
+              << static_cast<double>(allocations) / moved << " allocations/element" << std::endl;
+}
+
+void bench_handles() {
+    Random random;
+    std::vector<int> keys;
+    for (int i = 0; i < 500000; ++i) {
+        keys.push_back(random.get_int(0, 1 << 29));
+    }
+
+    std::cout << keys.size() << " string entries moved between two shards" << std::endl;
+
+    measure("remove + insert        ", keys, false, [&keys](Shard& from, Shard& to) {
+        size_t moved = 0;
+        for (int key : keys) {
+            if (from.contains(key)) {
+                to.insert(key, from.at(key));
+                from.remove(key);
+                ++moved;
+            }
+        }
+        return moved;
+    });
+
+    measure("extract + insert       ", keys, true, [&keys](Shard& from, Shard& to) {
+        size_t moved = 0;
+        for (int key : keys) {
+            moved += to.insert(from.extract(key)) ? 1 : 0;
+        }
+        return moved;
+    });
+
+    measure("extract, other arena   ", keys, false, [&keys](Shard& from, Shard& to) {
+        size_t moved = 0;
+        for (int key : keys) {
+            moved += to.insert(from.extract(key)) ? 1 : 0;
+        }
+        return moved;
+    });
+
+    measure("merge                  ", keys, true, [](Shard& from, Shard& to) {
+        return to.merge(from);
+    });
+}
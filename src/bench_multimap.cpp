@@ -0,0 +1,65 @@
+#include <iostream>
+#include <vector>
+
+#include "../tree.h"
+#include "../multi_tree.h"
+#include "../helper_classes.h"
+#include "alloc_counter.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+// Поток событий: ключи с распределением, близким к Ципфу, значение - номер события.
+static std::vector<int> make_events(size_t count, int distinct, Random& random) {
+    std::vector<int> events(count);
+    for (int& key : events) {
+        int a = random.get_int(1, distinct);
+        int b = random.get_int(1, distinct);
+        key = static_cast<int>(static_cast<long long>(a) * b / distinct); // частые малые ключи, редкие большие
+    }
+    return events;
+}
+
+static void report(const char* name, const Alloc_stats& before, const Alloc_stats& after, double seconds) {
+    std::cout << name << ": " << seconds << " s, allocations " << after.allocations - before.allocations
+              << ", live blocks " << after.live_blocks - before.live_blocks
+              << ", live bytes " << after.live_bytes - before.live_bytes << std::endl;
+}
+
+void bench_multimap() {
+    const size_t events_count = 1000000;
+
+    Random random;
+    for (int distinct : { 1000, 100000, 1000000 }) {
+        std::vector<int> events = make_events(events_count, distinct, random);
+        std::cout << "distinct keys up to " << distinct << std::endl;
+
+        // время и выделения читаются до деструктора region, который печатает счётчики
+        {
+            Perf_region region("BST<int, vector<int>> insert", events.size());
+            Alloc_stats before = get_alloc_stats();
+            Timer timer;
+            BST<int, std::vector<int>> tree;
+            for (size_t i = 0; i < events.size(); ++i) {
+                try {
+                    tree.at(events[i]).push_back(static_cast<int>(i));
+                } catch (const Array_exception&) {
+                    tree.insert(events[i], std::vector<int>{ static_cast<int>(i) });
+                }
+            }
+            double seconds = timer.elapsed();
+            report("  BST<int, vector<int>>", before, get_alloc_stats(), seconds);
+        }
+
+        {
+            Perf_region region("Multi_BST<int, int> insert", events.size());
+            Alloc_stats before = get_alloc_stats();
+            Timer timer;
+            Multi_BST<int, int> tree;
+            for (size_t i = 0; i < events.size(); ++i) {
+                tree.insert(events[i], static_cast<int>(i));
+            }
+            double seconds = timer.elapsed();
+            report("  Multi_BST<int, int>  ", before, get_alloc_stats(), seconds);
+        }
+    }
+}
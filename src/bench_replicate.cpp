@@ -0,0 +1,95 @@
+#include <iostream>
+#include <vector>
+#include <sstream>
+#include <string>
+
+#include "../tree.h"
+#include "../helper_classes.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+using Hash_tree = BST<int, int, Hash_augmentation<int, int>>;
+
+// Прежняя синхронизация: полный список ключей и все данные.
+static size_t full_snapshot(Hash_tree& tree, std::ostream& out) {
+    std::vector<int> keys = tree.get_keys();
+    for (int key : keys) {
+        out.write(reinterpret_cast<const char*>(&key), sizeof(key));
+        out.write(reinterpret_cast<const char*>(&tree.at(key)), sizeof(int));
+    }
+    return keys.size();
+}
+
+void bench_replicate() {
+    Random random;
+    const int count = 1000000;
+
+    Hash_tree base;
+    for (int i = 0; i < count; ++i) {
+        int key = random.get_int(0, 1 << 29);
+        base.insert(key, key);
+    }
+    std::vector<std::pair<int, int>> items;
+    for (int key : base.get_keys()) {
+        items.emplace_back(key, key);
+    }
+    Hash_tree other_shape;
+    other_shape.insert_sorted(items);
+
+    // время читается до деструктора region, который печатает счётчики
+    std::stringstream snapshot;
+    double snapshot_time = 0;
+    {
+        Perf_region region("full snapshot per key", base.get_size());
+        Timer timer;
+        full_snapshot(base, snapshot);
+        snapshot_time = timer.elapsed();
+    }
+    std::cout << base.get_size() << " keys; full snapshot: " << snapshot.str().size() << " bytes, "
+              << snapshot_time * 1e3 << " ms" << std::endl;
+    std::cout << "  changes   diff same shape   diff other shape   delta bytes   write+apply" << std::endl;
+
+    for (int changes : { 1, 100, 10000 }) {
+        Hash_tree primary(base);
+        for (int i = 0; i < changes; ++i) {
+            int key = random.get_int(0, 1 << 29);
+            if (!primary.update(key, -key)) {
+                primary.insert(key, key);
+            }
+        }
+
+        std::string label = std::to_string(changes) + " changes";
+        size_t same = 0;
+        double same_time = 0;
+        {
+            Perf_region region(label + ", diff same shape", 1);
+            Timer timer;
+            same = primary.diff(base).size();
+            same_time = timer.elapsed();
+        }
+
+        size_t other = 0;
+        double other_time = 0;
+        {
+            Perf_region region(label + ", diff other shape", 1);
+            Timer timer;
+            other = primary.diff(other_shape).size();
+            other_time = timer.elapsed();
+        }
+
+        Hash_tree replica(base);
+        std::stringstream delta;
+        double sync_time = 0;
+        {
+            Perf_region region(label + ", write+apply", 1);
+            Timer timer;
+            primary.write_delta(replica, delta);
+            replica.apply_delta(delta);
+            sync_time = timer.elapsed();
+        }
+
+        std::cout << "  " << changes << "\t    " << same_time * 1e3 << " ms (" << same << ")\t"
+                  << other_time * 1e3 << " ms (" << other << ")\t" << delta.str().size() << "\t"
+                  << sync_time * 1e3 << " ms" << std::endl;
+    }
+}
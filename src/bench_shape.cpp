@@ -0,0 +1,88 @@
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "../tree.h"
+#include "../helper_classes.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+static void print_stats(const Tree_stats& stats) {
+    std::cout << "  nodes " << stats.nodes << ", height " << stats.height
+              << ", avg search depth " << stats.average_search_depth
+              << " (optimal " << stats.optimal_search_depth << ", miss " << stats.miss_search_depth
+              << "), degeneration " << stats.degeneration << std::endl;
+}
+
+static double time_lookups(const std::string& name, BST<int, int>& tree, const std::vector<int>& keys) {
+    long long checksum = 0;
+    double elapsed = 0;
+    {
+        // время читается до деструктора region, который печатает счётчики
+        Perf_region region(name, keys.size());
+        Timer timer;
+        for (int key : keys) {
+            checksum += tree.at(key);
+        }
+        elapsed = timer.elapsed();
+    }
+    if (checksum == 42) {
+        std::cout << "";
+    }
+    return elapsed;
+}
+
+static void analyze_and_rebalance(const char* name, BST<int, int>& tree, const std::vector<int>& lookups) {
+    std::cout << name << std::endl;
+
+    Timer timer;
+    Tree_stats stats = tree.analyze();
+    std::cout << "  analyze: " << timer.elapsed() << " s" << std::endl;
+    print_stats(stats);
+
+    double before = time_lookups("at before rebalance", tree, lookups);
+    timer.reset();
+    tree.rebalance();
+    double rebalance_time = timer.elapsed();
+    double after = time_lookups("at after rebalance", tree, lookups);
+
+    // rebalance() только перевязывает узлы: в памяти они лежат в порядке вставки
+    timer.reset();
+    tree.compact(Compact_layout::breadth_first);
+    double compact_time = timer.elapsed();
+    double laid_out = time_lookups("at after breadth-first compact", tree, lookups);
+
+    std::cout << "  rebalance: " << rebalance_time << " s, compact: " << compact_time << " s, "
+              << lookups.size() << " lookups " << before << " s -> " << after << " s (rebalance) -> "
+              << laid_out << " s (+ compact)" << std::endl;
+    print_stats(tree.analyze());
+}
+
+void bench_shape() {
+    Random random;
+
+    BST<int, int> random_tree;
+    std::vector<int> keys;
+    while (keys.size() < 1000000) {
+        int key = random.get_int(0, 1 << 30);
+        if (random_tree.insert(key, key)) {
+            keys.push_back(key);
+        }
+    }
+    std::vector<int> lookups;
+    for (int i = 0; i < 1000000; ++i) {
+        lookups.push_back(keys[random.get_int(0, static_cast<int>(keys.size()) - 1)]);
+    }
+    analyze_and_rebalance("random insertion order, 1M keys", random_tree, lookups);
+
+    const int chain_size = 20000;
+    BST<int, int> chain;
+    for (int key = 1; key <= chain_size; ++key) {
+        chain.insert(key, key);
+    }
+    std::vector<int> chain_lookups;
+    for (int i = 0; i < 20000; ++i) {
+        chain_lookups.push_back(random.get_int(1, chain_size));
+    }
+    analyze_and_rebalance("sorted insertion order, 20K keys", chain, chain_lookups);
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <vector>
+
+#include "../tree.h"
+#include "../static_map.h"
+#include "../helper_classes.h"
+#include "alloc_counter.h"
+#include "perf_counters.h"
+#include "benchmarks.h"
+
+// Таблица из 512 разреженных "кодов операций", известная во время компиляции.
+static constexpr int table_size = 512;
+
+static constexpr int opcode(int i) {
+    return (i * 2654435761u) % 100003; // различны для i < table_size
+}
+
+static constexpr auto opcode_table = [] {
+    std::pair<int, int> items[table_size];
+    for (int i = 0; i < table_size; ++i) {
+        items[i] = { opcode(i), i };
+    }
+    return make_static_map(items);
+}();
+
+void bench_static() {
+    Random random;
+    const int lookup_count = 10000000;
+
+    std::vector<int> lookups;
+    for (int i = 0; i < lookup_count; ++i) {
+        lookups.push_back(opcode(random.get_int(0, table_size - 1)));
+    }
+
+    BST<int, int> tree;
+    size_t allocations = 0;
+    double build_time = 0;
+    {
+        // время и выделения читаются до деструктора region, который печатает счётчики
+        Perf_region region("BST insert", table_size);
+        allocations = get_alloc_stats().allocations;
+        Timer timer;
+        for (int i = 0; i < table_size; ++i) {
+            tree.insert(opcode(i), i);
+        }
+        build_time = timer.elapsed();
+        allocations = get_alloc_stats().allocations - allocations;
+    }
+
+    long long checksum = 0;
+    double tree_time = 0;
+    {
+        Perf_region region("BST at", lookups.size());
+        Timer timer;
+        for (int key : lookups) {
+            checksum += tree.at(key);
+        }
+        tree_time = timer.elapsed() / lookup_count;
+    }
+
+    double table_time = 0;
+    {
+        Perf_region region("Static_map at", lookups.size());
+        Timer timer;
+        for (int key : lookups) {
+            checksum += opcode_table.at(key);
+        }
+        table_time = timer.elapsed() / lookup_count;
+    }
+
+    std::cout << table_size << " keys, " << lookup_count << " lookups" << std::endl;
+    std::cout << "  BST (runtime)     : startup " << build_time * 1e6 << " us, " << allocations
+              << " allocations, lookup " << tree_time * 1e9 << " ns" << std::endl;
+    std::cout << "  Static_map (const): startup 0 us, 0 allocations, lookup " << table_time * 1e9 << " ns, "
+              << sizeof(opcode_table) << " bytes" << std::endl;
+    if (checksum == 42) {
+        std::cout << "";
+    }
+}
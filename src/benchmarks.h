@@ -0,0 +1,36 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+// Каждый замер печатает результаты в std::cout.
+
+void bench_lookup_cache();
+
+void bench_buffered_insert();
+
+void bench_multimap();
+
+void bench_dump();
+
+void bench_shape();
+
+void bench_balance();
+
+void bench_art();
+
+void bench_augment();
+
+void bench_filter();
+
+void bench_disk();
+
+void bench_compact();
+
+void bench_replicate();
+
+void bench_handles();
+
+void bench_static();
+
+void bench_expiry();
+
+#endif
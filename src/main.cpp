@@ -0,0 +1,53 @@
+#include <iostream>
+#include <string>
+#include <cstring>
+
+#include "benchmarks.h"
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+    bool by_default; // запускается без аргументов
+};
+
+static const Benchmark benchmarks[] = {
+    { "cache", bench_lookup_cache, true },
+    { "buffered", bench_buffered_insert, true },
+    { "multimap", bench_multimap, true },
+    { "dump", bench_dump, true },
+    { "shape", bench_shape, true },
+    { "balance", bench_balance, true },
+    { "art", bench_art, true },
+    { "augment", bench_augment, true },
+    { "filter", bench_filter, true },
+    { "disk", bench_disk, false },
+    { "compact", bench_compact, true },
+    { "replicate", bench_replicate, true },
+    { "handles", bench_handles, true },
+    { "static", bench_static, true },
+    { "expiry", bench_expiry, true },
+};
+
+// Без аргументов запускаются все замеры, кроме disk (пишет гигабайты журнала во временный каталог),
+// иначе - только перечисленные по имени.
+int main(int argc, char** argv) {
+    for (const Benchmark& bench : benchmarks) {
+        bool selected = (argc == 1 && bench.by_default);
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], bench.name) == 0) {
+                selected = true;
+            }
+        }
+
+        if (argc == 1 && !bench.by_default) {
+            std::cout << "== " << bench.name << " == skipped, run ./program " << bench.name << std::endl;
+        }
+
+        if (selected) {
+            std::cout << "== " << bench.name << " ==" << std::endl;
+            bench.run();
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <utility>
+
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char* const event_names[perf_event_count] = {
+    "cycles", "instr", "cache-ref", "cache-miss", "branch-miss", "dTLB-miss"
+};
+
+struct Counters {
+    int fds[perf_event_count];
+    std::string error;
+
+    Counters();
+    ~Counters();
+};
+
+#ifdef __linux__
+
+Counters::Counters() {
+    const uint32_t types[perf_event_count] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+        PERF_TYPE_HW_CACHE
+    };
+    const uint64_t configs[perf_event_count] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_REFERENCES,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+    };
+
+    for (int i = 0; i < perf_event_count; ++i) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = types[i];
+        attr.config = configs[i];
+        attr.exclude_kernel = 1; // не требует прав администратора при perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // счётчики независимы: отсутствие одного события не отключает остальные
+        fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fds[i] < 0 && error.empty()) {
+            error = std::string(event_names[i]) + ": perf_event_open: " + std::strerror(errno);
+        }
+    }
+}
+
+Counters::~Counters() {
+    for (int fd : fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+#else
+
+Counters::Counters() : error("perf_event_open is Linux-only") {
+    for (int& fd : fds) {
+        fd = -1;
+    }
+}
+
+Counters::~Counters() {}
+
+#endif
+
+Counters& counters() {
+    static Counters instance; // открываются при первом замере
+    return instance;
+}
+
+}
+
+Perf_sample read_perf_counters() {
+    Perf_sample sample;
+    Counters& all = counters();
+
+    for (int i = 0; i < perf_event_count; ++i) {
+        sample.values[i] = 0;
+        sample.valid[i] = false;
+
+#ifdef __linux__
+        uint64_t data[3]; // значение, время включения, время работы
+        if (all.fds[i] >= 0 && read(all.fds[i], data, sizeof(data)) == static_cast<ssize_t>(sizeof(data)) && data[2] > 0) {
+            // при нехватке аппаратных регистров ядро мультиплексирует счётчики
+            sample.values[i] = static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]);
+            sample.valid[i] = true;
+        }
+#endif
+    }
+
+    return sample;
+}
+
+bool perf_counters_available() {
+    for (int fd : counters().fds) {
+        if (fd >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::string& perf_counters_error() {
+    return counters().error;
+}
+
+Perf_region::Perf_region(std::string region_name, size_t operation_count)
+    : name(std::move(region_name)), operations(operation_count == 0 ? 1 : operation_count), start(read_perf_counters()) {}
+
+Perf_region::~Perf_region() {
+    static bool reported = false;
+    if (!perf_counters_available()) {
+        if (!reported) {
+            std::cout << "    [perf] counters unavailable (" << perf_counters_error() << ")" << std::endl;
+            reported = true;
+        }
+        return;
+    }
+
+    Perf_sample end = read_perf_counters();
+    std::cout << "    [perf] " << name << " per op:";
+    for (int i = 0; i < perf_event_count; ++i) {
+        std::cout << ' ' << event_names[i] << ' ';
+        if (start.valid[i] && end.valid[i]) {
+            std::cout << static_cast<double>(end.values[i] - start.values[i]) / static_cast<double>(operations);
+        } else {
+            std::cout << "n/a";
+        }
+    }
+
+    // IPC - отношение приращений, а не величина на одну операцию
+    std::cout << " IPC ";
+    bool have_ipc = start.valid[perf_cycles] && end.valid[perf_cycles]
+                    && start.valid[perf_instructions] && end.valid[perf_instructions]
+                    && end.values[perf_cycles] > start.values[perf_cycles];
+    if (have_ipc) {
+        std::cout << static_cast<double>(end.values[perf_instructions] - start.values[perf_instructions])
+                     / static_cast<double>(end.values[perf_cycles] - start.values[perf_cycles]);
+    } else {
+        std::cout << "n/a";
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,54 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Аппаратные счётчики процессора (Linux perf_event_open) для замеров.
+// Если счётчики недоступны (контейнер, perf_event_paranoid, не Linux), замеры
+// продолжают работать, а вместо чисел печатается одна строка с причиной.
+
+enum Perf_event {
+    perf_cycles,
+    perf_instructions,
+    perf_cache_references,
+    perf_cache_misses,
+    perf_branch_misses,
+    perf_dtlb_misses,
+    perf_event_count
+};
+
+struct Perf_sample {
+    uint64_t values[perf_event_count];
+    bool valid[perf_event_count]; // счётчик открыт и успел поработать
+};
+
+// Текущие значения всех счётчиков (с поправкой на мультиплексирование).
+Perf_sample read_perf_counters();
+
+// Хотя бы один счётчик доступен.
+bool perf_counters_available();
+
+// Причина недоступности счётчиков (пустая, если все открыты).
+const std::string& perf_counters_error();
+
+// Замер области: при уничтожении печатает приращения счётчиков на одну операцию
+// и число инструкций за такт (IPC).
+// Области можно вкладывать: счётчики работают непрерывно, область читает разность.
+class Perf_region {
+private:
+    std::string name;
+    size_t operations;
+    Perf_sample start;
+
+public:
+    Perf_region(std::string region_name, size_t operation_count);
+
+    Perf_region(const Perf_region&) = delete;
+    Perf_region& operator=(const Perf_region&) = delete;
+
+    ~Perf_region();
+};
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef STATIC_MAP_H
+#define STATIC_MAP_H
+
+#include <array>
+#include <vector>
+#include <bit>       // for std::countr_one
+#include <algorithm> // for std::sort
+#include <cstddef>
+#include <type_traits>
+#include <utility>   // for std::pair
+#include "array_exception.h"
+
+/**
+ * \brief Неизменяемое упорядоченное отображение, построенное во время компиляции.
+ *
+ * Ключи хранятся в std::array в порядке Эйтцингера: корень идеально сбалансированного
+ * дерева поиска в ячейке 1, потомки ячейки k - в ячейках 2k и 2k + 1. Верхние уровни дерева
+ * лежат рядом в начале массива, указателей нет, поиск - спуск по индексам с одним сравнением на уровень.
+ * Объект, объявленный constexpr, не выделяет памяти и не требует построения при запуске.
+ * Интерфейс поиска совпадает с BST: at(), operator[], contains(), get_size(), get_keys().
+*/
+template<typename Key, typename Data, size_t N>
+class Static_map {
+private:
+    static_assert(N > 0, "Static_map must not be empty");
+    static_assert(std::is_default_constructible_v<Key> && std::is_default_constructible_v<Data>,
+                  "Static_map stores keys and data in arrays");
+
+    // ячейка 0 не используется: так индексы потомков получаются без сложений
+    std::array<Key, N + 1> keys{};
+    std::array<Data, N + 1> values{};
+
+    // Симметричный обход неявного дерева: первая ячейка и ячейка после k (0 - обход окончен).
+    static constexpr size_t first_in_order() {
+        size_t k = 1;
+        while (2 * k <= N) {
+            k = 2 * k;
+        }
+        return k;
+    }
+
+    static constexpr size_t next_in_order(size_t k) {
+        if (2 * k + 1 <= N) { // к самому левому узлу правого поддерева
+            k = 2 * k + 1;
+            while (2 * k <= N) {
+                k = 2 * k;
+            }
+            return k;
+        }
+
+        while (k & 1) { // вверх, пока поднимаемся из правого поддерева
+            k >>= 1;
+        }
+        return k >> 1;
+    }
+
+    // Индекс наименьшего ключа, не меньшего key, или 0, если такого нет.
+    constexpr size_t lower_bound(const Key& key) const {
+        size_t k = 1;
+        while (k <= N) {
+            k = 2 * k + (keys[k] < key ? 1 : 0);
+        }
+
+        // спуск вправо добавлял единичные биты: их серия и ещё один шаг ведут к ответу
+        return k >> (std::countr_one(k) + 1);
+    }
+
+    constexpr size_t find_index(const Key& key) const {
+        size_t k = lower_bound(key);
+        return (k != 0 && !(key < keys[k])) ? k : 0;
+    }
+
+public:
+    /**
+     * \brief Построение по парам (ключ, данные) в любом порядке.
+     * \param items Пары с попарно различными ключами.
+     * \post Ключи разложены в порядке Эйтцингера.
+     * \throw Array_exception если ключи повторяются (при constexpr-построении - ошибка компиляции).
+    */
+    constexpr explicit Static_map(const std::pair<Key, Data> (&items)[N]) {
+        std::array<std::pair<Key, Data>, N> sorted{};
+        for (size_t i = 0; i < N; ++i) {
+            sorted[i] = items[i];
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const std::pair<Key, Data>& a, const std::pair<Key, Data>& b) {
+            return a.first < b.first;
+        });
+
+        for (size_t i = 1; i < N; ++i) {
+            if (!(sorted[i - 1].first < sorted[i].first)) {
+                throw Array_exception("Duplicate key in Static_map");
+            }
+        }
+
+        // симметричный обход неявного дерева раздаёт ячейкам ключи по возрастанию
+        size_t next = 0;
+        for (size_t k = first_in_order(); k != 0; k = next_in_order(k)) {
+            keys[k] = sorted[next].first;
+            values[k] = sorted[next].second;
+            ++next;
+        }
+    }
+
+    /**
+     * \brief Получение размера отображения.
+    */
+    constexpr size_t get_size() const { return N; }
+
+    /**
+     * \brief Проверка отображения на пустоту.
+    */
+    constexpr bool is_empty() const { return N == 0; }
+
+    /**
+     * \brief Проверка наличия элемента с заданным ключом без исключений.
+     * \param key Ключ для поиска.
+     * \return true, если элемент существует, иначе false.
+    */
+    constexpr bool contains(const Key& key) const { return find_index(key) != 0; }
+
+    /**
+     * \brief Поиск элемента с заданным ключом.
+     * \param key Ключ для поиска.
+     * \return Константная ссылка на найденный элемент.
+     * \throw Array_exception если элемент с заданным ключом не существует
+     * (при вычислении во время компиляции - ошибка компиляции).
+    */
+    constexpr const Data& at(const Key& key) const {
+        size_t k = find_index(key);
+        if (k == 0) {
+            throw Array_exception("No such key in Static_map");
+        }
+        return values[k];
+    }
+
+    /**
+     * \brief Поиск элемента с заданным ключом.
+     * \throw Array_exception если элемент с заданным ключом не существует.
+    */
+    constexpr const Data& operator[](const Key& key) const { return at(key); }
+
+    /**
+     * \brief Поиск элемента без исключений.
+     * \return Указатель на данные или nullptr, если элемента нет.
+    */
+    constexpr const Data* find(const Key& key) const {
+        size_t k = find_index(key);
+        return k == 0 ? nullptr : &values[k];
+    }
+
+    /**
+     * \brief Список ключей по возрастанию, как BST::get_keys().
+    */
+    std::vector<Key> get_keys() const {
+        std::vector<Key> result;
+        result.reserve(N);
+
+        for (size_t k = first_in_order(); k != 0; k = next_in_order(k)) {
+            result.push_back(keys[k]);
+        }
+        return result;
+    }
+};
+
+/**
+ * \brief Построение Static_map с выводом размера: constexpr auto table = make_static_map<int, char>({ { 1, 'a' } });
+*/
+template<typename Key, typename Data, size_t N>
+constexpr Static_map<Key, Data, N> make_static_map(const std::pair<Key, Data> (&items)[N]) {
+    return Static_map<Key, Data, N>(items);
+}
+
+#endif
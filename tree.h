@@ -4,33 +4,240 @@
 #include <vector>
 #include <stack>
 #include <queue>
+#include <algorithm> // for std::fill
+#include <functional> // for std::hash
+#include <type_traits>
+#include <cstdint>
+#include <cmath> // for std::log, std::isfinite
+#include <limits>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <memory> // for std::shared_ptr
+#include <utility> // for std::move
 #include "array_exception.h"
+#include "helper_classes.h"
+#include "augmentation.h"
+#include "bloom_filter.h"
+#include "node_arena.h"
+
+/**
+ * \brief Формат вывода структуры дерева.
+*/
+enum class Dump_format {
+    text, // повёрнутое дерево с отступами, как в print_tree()
+    dot,  // описание графа для Graphviz
+    json  // вложенные объекты {"key", "data", "left", "right"}
+};
+
+/**
+ * \brief Параметры вывода структуры дерева.
+*/
+struct Dump_options {
+    Dump_format format = Dump_format::text;
+    size_t max_depth = std::numeric_limits<size_t>::max(); // поддеревья глубже заменяются многоточием
+    size_t max_nodes = std::numeric_limits<size_t>::max(); // после стольких узлов вывод обрывается
+    // Текст: глубже отступ не растёт, а глубина печатается числом "[глубина] ",
+    // поэтому вывод вырожденного дерева занимает O(n), а не O(n * высота).
+    size_t max_indent = 32;
+};
+
+/**
+ * \brief Характеристики формы дерева. Глубина корня равна 0.
+*/
+struct Tree_stats {
+    size_t nodes = 0;
+    size_t height = 0;                // число уровней (0 для пустого дерева)
+    size_t internal_path_length = 0;  // сумма глубин всех узлов
+    size_t external_path_length = 0;  // сумма глубин листьев, как в get_external_path_length()
+    std::vector<size_t> depth_histogram;     // [d] - число узлов на глубине d
+    std::vector<size_t> imbalance_histogram; // [k] - число узлов, у которых высоты поддеревьев отличаются на k
+    double average_search_depth = 0;  // среднее число сравнений при успешном поиске
+    double miss_search_depth = 0;     // среднее число сравнений при неуспешном поиске
+    double optimal_search_depth = 0;  // среднее число сравнений при успешном поиске в идеально сбалансированном дереве
+    double degeneration = 1;          // average_search_depth / optimal_search_depth, 1 - оптимальная форма
+};
+
+/**
+ * \brief Порядок размещения узлов в памяти при уплотнении дерева.
+*/
+enum class Compact_layout {
+    breadth_first, // по уровням: верхние уровни занимают несколько соседних кэш-линий (быстрее поиск)
+    in_order       // по возрастанию ключей: обход идёт по памяти последовательно (быстрее сканирование)
+};
+
+/**
+ * \brief Состояние фильтра Блума перед поиском.
+*/
+struct Filter_stats {
+    size_t memory_bytes = 0;      // объём битового массива
+    size_t capacity = 0;          // число ключей, на которое рассчитан фильтр
+    size_t keys = 0;              // ключей в фильтре (включая удалённые с последней перестройки)
+    double estimated_fpr = 0;     // расчётная вероятность ложного срабатывания
+    size_t rejects = 0;           // промахи, отсечённые фильтром без обхода дерева
+    size_t false_positives = 0;   // промахи, которые фильтр пропустил в дерево
+    double observed_fpr = 0;      // false_positives / (rejects + false_positives)
+};
 
-template<typename Key, typename Data>
+/**
+ * \brief Дерево бинарного поиска.
+ * \tparam Augment Дополнение - моноид, агрегат которого хранится в каждом узле для его
+ * поддерева (см. augmentation.h). По умолчанию дополнения нет, и узлы не занимают лишней памяти.
+*/
+template<typename Key, typename Data, typename Augment = No_augmentation>
 class BST {
 private:
+    static constexpr bool is_augmented = !std::is_same_v<Augment, No_augmentation>;
+
+    using Summary = typename Augment::value_type;
+
     struct Node {
         Key key;
         Data data;
         Node* left;
         Node* right;
+        [[no_unique_address]] Summary summary; // агрегат поддерева узла
 
         Node(const Key& k, const Data& d) : key(k), data(d), left(nullptr), right(nullptr) {}
+        Node(Key&& k, Data&& d) : key(std::move(k)), data(std::move(d)), left(nullptr), right(nullptr) {}
     };
 
     Node* root;
     size_t size;
 
+    // Все узлы размещаются в блоках распределителя; уплотнение переносит их в новое поколение.
+    // Распределитель разделяется с извлечёнными узлами и деревьями, вызвавшими share_node_arena().
+    std::shared_ptr<Node_arena<Node>> arena;
+    bool compacting = false;             // идёт пошаговое уплотнение
+    std::optional<Key> compact_cursor;   // последний ключ, пройденный пошаговым уплотнением
+    std::vector<Node**> compact_path;    // ссылки на ещё не пройденных предков
+
+    // Кэш последних найденных узлов (прямое отображение: ключ -> слот по хэшу).
+    // Пустой вектор означает, что кэш выключен. Изменяется и при const-поиске (см. enable_cache()).
+    mutable std::vector<Node*> cache;
+    int cache_shift = 0;
+    mutable size_t cache_hits = 0;
+    mutable size_t cache_misses = 0;
+
+    // Режим дерева козла отпущения: 0 - выключен, иначе коэффициент alpha из (0.5, 1).
+    // Кроме alpha хранится только наибольший размер дерева с последней полной перестройки.
+    double balance_alpha = 0;
+    double log_inverse_alpha = 0;
+    size_t max_size = 0;
+    std::vector<Node**> insert_path; // ссылки на узлы пути вставки
+    std::vector<Node*> update_path;  // узлы, агрегаты которых нужно пересчитать снизу вверх
+
+    // Фильтр Блума перед поиском: промах отсекается по одной кэш-линии без обхода дерева.
+    // Невключённый фильтр не занимает памяти.
+    Blocked_bloom_filter filter;
+    size_t filter_bits_per_key = 0;
+    size_t filter_removed = 0; // удалений с последней перестройки фильтра
+    mutable size_t filter_rejects = 0;
+    mutable size_t filter_false_positives = 0;
+
+    static constexpr bool key_is_hashable = std::is_default_constructible_v<std::hash<Key>>;
+
+    static uint64_t key_hash(const Key& key);
+
+    // Поиск узла без исключений: nullptr, если ключа нет.
+    Node* search(const Key& key) const;
+
+    // Спуск от корня без кэша, фильтра и счётчиков: не меняет состояние дерева.
+    Node* locate(const Key& key) const;
+
+    // Узел с наименьшим ключом, большим *key (с наименьшим ключом дерева, если key == nullptr).
+    Node* next_node(const Key* key) const;
+
     Node* find_node(const Key& key) const;
 
-    void show(Node* current, int level) const;
+    size_t cache_slot(const Key& key) const;
+
+    void filter_add(const Key& key);
+
+    void filter_remove();
+
+    void rebuild_filter(size_t capacity);
+
+    Node* create_node(const Key& key, const Data& data) { return arena->create(key, data); }
+
+    void destroy_node(Node* node) { arena->destroy(node); }
+
+    // Перенос узла по ссылке link в текущее поколение распределителя.
+    Node* relocate(Node** link);
+
+    // Уплотнение освобождает старые блоки, поэтому в них не должно быть чужих узлов.
+    void check_arena_exclusive() const;
+
+    // Завершение уплотнения: в старом поколении не осталось узлов, его блоки освобождаются.
+    void finish_compaction();
+
+    // Ссылка, по которой подвешивается узел с ключом key (nullptr, если ключ уже есть), и её глубина.
+    Node** find_insert_link(const Key& key, size_t& depth);
+
+    // Подвешивание узла по ссылке из find_insert_link() с учётом фильтра, агрегатов и балансировки.
+    void attach_node(Node** link, Node* node, size_t depth);
+
+    // Исключение узла с заданным ключом из дерева без освобождения (nullptr, если ключа нет).
+    // Узел с двумя потомками заменяется своим преемником перевязкой, без копирования ключа и данных.
+    Node* detach_node(const Key& key);
+
+    void cache_forget(const Key& key);
+
+    void dump_text(Node* start, Buffered_writer& writer, const Dump_options& options) const;
+
+    void dump_dot(Node* start, Buffered_writer& writer, const Dump_options& options) const;
+
+    void dump_json(Node* start, Buffered_writer& writer, const Dump_options& options) const;
+
+    void dump_from(Node* start, std::ostream& out, const Dump_options& options) const;
+
+    template<typename T>
+    static void write_label(Buffered_writer& writer, const T& value);
+
+    template<typename T>
+    static void write_json_value(Buffered_writer& writer, const T& value);
+
+    Node* build_balanced(const std::pair<Key, Data>* items, size_t count);
+
+    static Node* link_balanced(Node** nodes, size_t count);
+
+    static size_t subtree_size(Node* node);
+
+    // Вытягивание дерева правыми поворотами в "лозу" - цепочку правых потомков по возрастанию ключей.
+    static size_t flatten(Node*& start);
+
+    // Допустимая глубина узла в alpha-сбалансированном дереве из count узлов.
+    size_t alpha_height(size_t count) const;
+
+    void rebuild_subtree(Node*& link, size_t count);
+
+    void rebuild_scapegoat(Node* inserted);
+
+    static Summary summary_of(Node* node);
+
+    // Пересчёт агрегата узла по агрегатам его потомков.
+    static void pull(Node* node);
+
+    // Пересчёт агрегатов всего поддерева (после перестроек, меняющих форму целиком).
+    static void pull_subtree(Node* node);
+
+    // Пересчёт агрегатов на пути вставки после подвешивания новых узлов.
+    void pull_insert_path();
+
+    // Агрегат элементов с ключами строго между *lo и *hi (nullptr - граница отсутствует).
+    Summary summary_between(const Key* lo, const Key* hi) const;
+
+    // Ключи поддерева start, лежащие строго между *lo и *hi, по возрастанию.
+    static void collect_between(Node* start, const Key* lo, const Key* hi, std::vector<Key>& keys);
 
 public:
     /**
      * \brief Конструктор по умолчанию.
      * \post Дерево пустое.
     */
-    BST() : root(nullptr), size(0) {}
+    BST() : root(nullptr), size(0), arena(std::make_shared<Node_arena<Node>>()) {}
 
     /**
      * \brief Конструктор копирования.
@@ -103,6 +310,30 @@ public:
     */
     const Data& at(const Key& key) const;
 
+    /**
+     * \brief Проверка наличия элемента с заданным ключом без исключений.
+     * \param key Ключ для поиска.
+     * \return true, если элемент существует, иначе false.
+     * \post Дерево остаётся неизменным.
+    */
+    bool contains(const Key& key) const { return search(key) != nullptr; }
+
+    /**
+     * \brief Поиск элемента с заданным ключом без исключений.
+     * \param key Ключ для поиска.
+     * \return Указатель на данные элемента или nullptr, если элемента нет.
+     * \post Дерево остаётся неизменным.
+    */
+    Data* find(const Key& key) {
+        Node* node = search(key);
+        return node == nullptr ? nullptr : &node->data;
+    }
+
+    const Data* find(const Key& key) const {
+        Node* node = search(key);
+        return node == nullptr ? nullptr : &node->data;
+    }
+
     /**
      * \brief Вставляет данные с заданным ключом в дерево.
      * \param key Ключ для вставки.
@@ -113,6 +344,17 @@ public:
     */
     bool insert(const Key& key, const Data& data);
 
+    /**
+     * \brief Пакетная вставка упорядоченной последовательности пар (ключ, данные).
+     * \param items Пары, упорядоченные по возрастанию ключа, без повторяющихся ключей.
+     * \pre Ключи в items строго возрастают.
+     * \post Вставлены все пары, ключей которых не было в дереве. Пары, попавшие
+     * между двумя соседними ключами дерева, подвешиваются сбалансированным поддеревом.
+     * \return Число вставленных элементов.
+     * \throw Array_exception если ключи в items не строго возрастают (дерево не меняется).
+    */
+    size_t insert_sorted(const std::vector<std::pair<Key, Data>>& items);
+
     /**
      * \brief Удаляет элемент с заданным ключом из дерева.
      * \param key Ключ для удаления.
@@ -136,12 +378,280 @@ public:
     */
     size_t get_external_path_length() const;
 
+    /**
+     * \brief Анализ формы дерева за один нерекурсивный обход.
+     * \return Высота, длины путей, гистограммы глубин и разбалансировки, оценки стоимости поиска.
+     * \post Дерево остаётся неизменным.
+    */
+    Tree_stats analyze() const;
+
+    /**
+     * \brief Перестройка дерева в идеально сбалансированное на месте (алгоритм Дэя - Стаута - Уоррена).
+     * \post Высота дерева минимальна, ключи и данные узлов не изменены. Время O(n), доп. память O(1).
+     * Узлы только перевязываются и лежат в памяти в порядке вставки: на больших случайных деревьях
+     * поиск ускоряется лишь вместе с последующим compact(Compact_layout::breadth_first).
+    */
+    void rebalance();
+
+    /**
+     * \brief Включение режима дерева козла отпущения (scapegoat tree).
+     * \param alpha Коэффициент сбалансированности из (0.5, 1), 0 - выключить режим.
+     * \post Глубина дерева не превышает log_{1/alpha}(n) + 1: вставка, обнаружившая слишком
+     * глубокий путь, перестраивает поддерево-"козла отпущения" за линейное время, а удаление
+     * перестраивает всё дерево, когда размер падает ниже alpha от максимального.
+     * Дополнительной памяти в узлах не требуется.
+     * \throw Array_exception если alpha вне допустимого диапазона.
+    */
+    void enable_scapegoat(double alpha = 0.7);
+
+    /**
+     * \brief Уплотнение: перенос всех узлов в один непрерывный блок памяти в заданном порядке.
+     * \param layout Порядок размещения узлов.
+     * \post Форма дерева, ключи и данные не изменены, старые блоки памяти освобождены.
+     * Ссылки на данные, полученные до уплотнения, недействительны. Время O(n).
+    */
+    void compact(Compact_layout layout = Compact_layout::breadth_first);
+
+    /**
+     * \brief Шаг пошагового уплотнения в порядке возрастания ключей.
+     * \param budget Наибольшее число узлов, просматриваемых за шаг (работа O(budget + высота)).
+     * \return true, если уплотнение завершено (старые блоки освобождены), иначе false.
+     * \post Между шагами дерево можно изменять: позиция хранится как ключ, а не как указатель.
+     * Ссылки на данные перенесённых узлов недействительны.
+    */
+    bool compact_step(size_t budget);
+
+    /**
+     * \brief Объём памяти под узлы (включая свободные места в блоках) в байтах.
+     * \post Дерево остаётся неизменным.
+    */
+    size_t get_node_memory() const { return arena->get_memory(); }
+
+    /**
+     * \brief Замена данных элемента с пересчётом агрегатов на пути к нему.
+     * \param key Ключ элемента.
+     * \param data Новые данные.
+     * \return true, если элемент найден, иначе false.
+     * \post Изменения данных через ссылки из at() и operator[] агрегатами не учитываются,
+     * поэтому в дереве с дополнением данные следует менять этим методом.
+    */
+    bool update(const Key& key, const Data& data);
+
+    /**
+     * \brief Агрегат элементов с ключами из отрезка [lo, hi] за O(высоты дерева).
+     * \param lo Нижняя граница ключа.
+     * \param hi Верхняя граница ключа.
+     * \return Свёртка Augment::lift по элементам в порядке возрастания ключей;
+     * Augment::identity(), если таких элементов нет.
+     * \post Дерево остаётся неизменным.
+    */
+    Summary aggregate(const Key& lo, const Key& hi) const;
+
+    /**
+     * \brief Агрегат всех элементов дерева за O(1).
+     * \post Дерево остаётся неизменным.
+    */
+    Summary get_summary() const;
+
+    /**
+     * \brief Обход элементов с отсечением поддеревьев по агрегату.
+     * \param descend Предикат от агрегата: поддерево просматривается, только если он истинен
+     * для агрегата поддерева, а элемент посещается, только если он истинен для его Augment::lift.
+     * \param visit Функция (key, data), вызываемая для посещённых элементов по возрастанию ключей.
+     * \post Дерево остаётся неизменным. Для монотонных предикатов (например,
+     * Interval_augmentation::overlapping) время O(k * высота), где k - число посещённых элементов.
+    */
+    template<typename Descend, typename Visit>
+    void visit_where(Descend descend, Visit visit) const;
+
+    /**
+     * \brief Обход всех элементов по возрастанию ключей.
+     * \param visit Функция (key, data), вызываемая для каждого элемента.
+     * \post Дерево остаётся неизменным. Время O(n) без промежуточных копий ключей.
+    */
+    template<typename Visit>
+    void visit_in_order(Visit visit) const;
+
+    /**
+     * \brief Ключи, по которым дерево отличается от другого: есть только в одном из деревьев
+     * или имеют разные данные.
+     * \param other Другое дерево (например, реплика).
+     * \return Различающиеся ключи по возрастанию.
+     * \post Деревья остаются неизменными. Поддеревья с равными агрегатами пропускаются, поэтому
+     * с Hash_augmentation время O(d * высота) для деревьев одной формы и O(d * высота * log n)
+     * для разной, где d - число различий.
+    */
+    std::vector<Key> diff(const BST& other) const;
+
+    /**
+     * \brief Запись изменений, переводящих дерево base в текущее.
+     * \param base Состояние реплики, которой предназначены изменения.
+     * \param out Поток вывода (файл, канал, строковый поток).
+     * \return Число записанных изменений.
+     * \post Деревья остаются неизменными. В заголовок записываются агрегаты base и текущего
+     * дерева, по которым apply_delta() проверяет, к чему применяются изменения и что получилось.
+    */
+    size_t write_delta(const BST& base, std::ostream& out) const;
+
+    /**
+     * \brief Применение изменений, записанных write_delta().
+     * \param in Поток ввода.
+     * \return Число применённых изменений.
+     * \post Дерево совпадает с деревом, для которого записаны изменения.
+     * \throw Array_exception если изменения обрезаны или записаны не для этого дерева (дерево
+     * не изменяется), или если результат не совпал с агрегатом, записанным в заголовке.
+    */
+    size_t apply_delta(std::istream& in);
+
+    /**
+     * \brief Извлечённый из дерева узел (аналог node_type у std::map).
+     * Владеет узлом: узел, не вставленный обратно ни в одно дерево, освобождается в деструкторе.
+    */
+    class Node_handle {
+    private:
+        friend class BST;
+
+        Node* node = nullptr;
+        std::shared_ptr<Node_arena<Node>> owner; // распределитель узла живёт, пока жив узел
+
+        Node_handle(Node* extracted, const std::shared_ptr<Node_arena<Node>>& arena) : node(extracted), owner(arena) {}
+
+        Node* release() {
+            Node* released = node;
+            node = nullptr;
+            owner.reset();
+            return released;
+        }
+
+        void reset() {
+            if (node != nullptr) {
+                owner->destroy(node);
+                node = nullptr;
+            }
+            owner.reset();
+        }
+
+    public:
+        Node_handle() = default;
+        Node_handle(const Node_handle&) = delete;
+        Node_handle& operator=(const Node_handle&) = delete;
+
+        Node_handle(Node_handle&& other) noexcept : node(other.node), owner(std::move(other.owner)) {
+            other.node = nullptr;
+        }
+
+        Node_handle& operator=(Node_handle&& other) noexcept {
+            if (this != &other) {
+                reset();
+                node = other.node;
+                owner = std::move(other.owner);
+                other.node = nullptr;
+            }
+            return *this;
+        }
+
+        ~Node_handle() {
+            reset();
+        }
+
+        bool empty() const { return node == nullptr; }
+
+        explicit operator bool() const { return node != nullptr; }
+
+        /**
+         * \brief Ключ узла. Его можно изменить перед вставкой в дерево.
+         * \throw Array_exception если узла нет.
+        */
+        Key& key() {
+            if (node == nullptr) {
+                throw Array_exception("Node handle is empty");
+            }
+            return node->key;
+        }
+
+        /**
+         * \brief Данные узла.
+         * \throw Array_exception если узла нет.
+        */
+        Data& data() {
+            if (node == nullptr) {
+                throw Array_exception("Node handle is empty");
+            }
+            return node->data;
+        }
+    };
+
+    /**
+     * \brief Извлечение узла с заданным ключом из дерева без освобождения памяти.
+     * \param key Ключ извлекаемого элемента.
+     * \return Узел элемента; пустой Node_handle, если элемента нет.
+     * \post Размер дерева уменьшается на 1. Ключ и данные не копируются: узел с двумя
+     * потомками заменяется в дереве своим приемником перевязкой указателей.
+    */
+    Node_handle extract(const Key& key);
+
+    /**
+     * \brief Вставка извлечённого узла.
+     * \param handle Узел, полученный extract() этого или другого дерева.
+     * \return true, если узел вставлен; false, если handle пуст или ключ уже есть в дереве
+     * (тогда узел остаётся в handle).
+     * \post Узел из общего распределителя (то же дерево или share_node_arena()) подвешивается
+     * без выделения памяти, узел чужого распределителя переносится в новый узел этого дерева.
+    */
+    bool insert(Node_handle&& handle);
+
+    /**
+     * \brief Перенос элемента с заданным ключом из другого дерева.
+     * \param source Дерево-источник.
+     * \param key Ключ элемента.
+     * \return true, если элемент перенесён; false, если его нет в source или ключ уже есть в дереве.
+    */
+    bool splice(BST& source, const Key& key);
+
+    /**
+     * \brief Перенос всех элементов другого дерева, ключей которых нет в этом дереве (как std::map::merge).
+     * \param source Дерево-источник; в нём остаются элементы с ключами, которые есть в этом дереве.
+     * \return Число перенесённых элементов.
+     * \post Если переносить нечего, деревья не меняются (проверка за O(m * высота) без выделения памяти).
+     * Иначе оба дерева вытягиваются в лозы, сливаются за O(n + m) и сворачиваются в сбалансированные
+     * (как rebalance()). При общем распределителе узлы только перевязываются, и без дополнения
+     * слияние не выделяет памяти.
+    */
+    size_t merge(BST& source);
+
+    /**
+     * \brief Переход на распределитель узлов другого дерева, чтобы обмениваться с ним узлами без выделения памяти.
+     * \param other Дерево, распределитель которого будет общим.
+     * \pre Дерево пустое.
+     * \post Пока распределитель общий (или есть извлечённые из него узлы), деревья нельзя уплотнять.
+     * \throw Array_exception если дерево не пустое или other уплотняется.
+    */
+    void share_node_arena(BST& other);
+
     /**
      * \brief Вывод структуры дерева в консоль. (обход L -> t -> R)
      * \post Дерево остаётся неизменным.
     */
     void print_tree() const;
 
+    /**
+     * \brief Вывод структуры дерева в поток без рекурсии через буфер.
+     * \param out Поток вывода (консоль, файл, строковый поток).
+     * \param options Формат вывода и ограничения на глубину и число узлов.
+     * \post Дерево остаётся неизменным.
+    */
+    void dump(std::ostream& out, const Dump_options& options = Dump_options()) const;
+
+    /**
+     * \brief Вывод поддерева с корнем в узле с заданным ключом.
+     * \param key Ключ корня поддерева.
+     * \param out Поток вывода.
+     * \param options Формат вывода и ограничения на глубину и число узлов.
+     * \post Дерево остаётся неизменным.
+     * \throw Array_exception если элемент с заданным ключом не существует в дереве.
+    */
+    void dump_subtree(const Key& key, std::ostream& out, const Dump_options& options = Dump_options()) const;
+
     /**
      * \brief Опрос числа узлов дерева, просмотренных предыдущей операцией.
      * \return Число узлов дерева, просмотренных предыдущей операци
@@ -149,12 +659,53 @@ public:
     */
     int print_nodes_visited() const;
 
+    /**
+     * \brief Включение кэша поиска перед at() и operator[].
+     * \param slots Число слотов кэша (округляется вверх до степени двойки, не меньше двух), 0 - выключить кэш.
+     * \post Кэш пуст, счётчики попаданий и промахов обнулены.
+     * Пока кэш включён, поиск через const-методы (at(), find(), contains()) записывает слоты кэша
+     * и счётчики, поэтому одновременное чтение дерева из нескольких потоков требует внешней
+     * синхронизации. Без кэша и фильтра const-поиск только читает дерево.
+     * \throw Array_exception если для типа ключа не определён std::hash.
+    */
+    void enable_cache(size_t slots);
+
+    /**
+     * \brief Опрос числа попаданий в кэш поиска.
+     * \return Число поисков, обслуженных кэшем без обхода дерева.
+     * \post Дерево остаётся неизменным.
+    */
+    size_t get_cache_hits() const { return cache_hits; }
+
+    /**
+     * \brief Опрос числа промахов кэша поиска.
+     * \return Число поисков, потребовавших обхода дерева.
+     * \post Дерево остаётся неизменным.
+    */
+    size_t get_cache_misses() const { return cache_misses; }
+
+    /**
+     * \brief Включение блочного фильтра Блума перед at(), operator[] и contains().
+     * \param expected_keys Ожидаемое число ключей (фильтр растёт вдвое при переполнении).
+     * \param bits_per_key Бит фильтра на ключ, 0 - выключить фильтр. 10 бит дают около 1% ложных срабатываний.
+     * \post Фильтр содержит все ключи дерева, счётчики отсечений обнулены. Фильтр перестраивается,
+     * когда с последней перестройки удалена половина ключей.
+     * \throw Array_exception если для типа ключа не определён std::hash.
+    */
+    void enable_filter(size_t expected_keys, size_t bits_per_key = 10);
+
+    /**
+     * \brief Объём памяти фильтра, вероятность ложного срабатывания и счётчики отсечений.
+     * \post Дерево остаётся неизменным.
+    */
+    Filter_stats get_filter_stats() const;
+
     /**
      * \brief Прямой итератор для обхода дерева бинарного поиска
     */
     class Iterator {
     private:
-        BST<Key, Data>& cur_tree;
+        BST& cur_tree;
         Node* cur_node;
 
         /**
@@ -247,9 +798,9 @@ public:
         }
 
     public:
-        Iterator(BST<Key, Data>& tree) : cur_tree(tree), cur_node(find_min(tree.root)) {}
+        Iterator(BST& tree) : cur_tree(tree), cur_node(find_min(tree.root)) {}
 
-        Iterator(BST<Key, Data>& tree, Node* node) : cur_tree(tree), cur_node(node) {}
+        Iterator(BST& tree, Node* node) : cur_tree(tree), cur_node(node) {}
 
         Data& operator*() {
             if (cur_node == nullptr) {
@@ -315,173 +866,1101 @@ public:
     Iterator rend();
 };
 
-template <typename Key, typename Data>
-BST<Key, Data>::BST(const BST& other) : BST() {
+template <typename Key, typename Data, typename Augment>
+BST<Key, Data, Augment>::BST(const BST& other) : BST() {
+    balance_alpha = other.balance_alpha;
+    log_inverse_alpha = other.log_inverse_alpha;
+    max_size = other.max_size;
+
     if (other.root == nullptr) {
         return;
     }
 
-    // стек с парами (узел, родитель)
-    std::stack<std::pair<Node*, Node*>> nodes_stack;
-    nodes_stack.push(std::make_pair(other.root, nullptr));
+    // стек с парами (узел, ссылка на место копии узла во втором дереве)
+    std::stack<std::pair<Node*, Node**>> nodes_stack;
+    nodes_stack.push(std::make_pair(other.root, &root));
 
     while (!nodes_stack.empty()) {
         Node* current = nodes_stack.top().first;
-        Node* parent = nodes_stack.top().second;
+        Node** link = nodes_stack.top().second;
         nodes_stack.pop();
 
-        Node *new_node = new Node(current->key, current->data);
-
-        if (parent == nullptr) { // мы на корне второго дерева
-            root = new_node;
-        } else if (current == parent->left) { // мы в левом поддереве
-            parent->left = new_node;
-        } else { // мы в правом поддереве
-            parent->right = new_node;
-        }
+        Node *new_node = create_node(current->key, current->data);
+        new_node->summary = current->summary;
+        *link = new_node;
 
         if (current->left != nullptr) {
-            nodes_stack.push(std::make_pair(current->left, new_node));
+            nodes_stack.push(std::make_pair(current->left, &new_node->left));
         }
 
         if (current->right != nullptr) {
-            nodes_stack.push(std::make_pair(current->right, new_node));
+            nodes_stack.push(std::make_pair(current->right, &new_node->right));
         }
     }
+
+    size = other.size;
+
+    filter = other.filter;
+    filter_bits_per_key = other.filter_bits_per_key;
+    filter_removed = other.filter_removed;
 }
 
-template <typename Key, typename Data>
-bool BST<Key, Data>::insert(const Key& key, const Data& data) {
-    if (root == nullptr) { // дерево пустое
-        root = new Node(key, data);
-        ++size;
-        return true;
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::check_arena_exclusive() const {
+    if (arena.use_count() > 1) {
+        throw Array_exception("Cannot compact nodes shared with other trees or node handles");
     }
+}
 
-    Node* current = root;
-    Node* parent = nullptr;
-    while (current != nullptr) { // ищем место вставки
-        parent = current;
-        if (key == current->key) { // дубликаты запрещены
-            return false;
-        } else if (key < current->key) {
-            current = current->left;
-        } else {
-            current = current->right;
-        }
+template <typename Key, typename Data, typename Augment>
+typename BST<Key, Data, Augment>::Node_handle BST<Key, Data, Augment>::extract(const Key& key) {
+    Node* node = detach_node(key);
+    if (node == nullptr) {
+        return Node_handle();
     }
 
-    Node* new_node = new Node(key, data);
+    return Node_handle(node, arena);
+}
 
-    if (key < parent->key) { // создаем необходимые связи в дереве с новым узлом
-        parent->left = new_node;
-    } else {
-        parent->right = new_node;
+template <typename Key, typename Data, typename Augment>
+bool BST<Key, Data, Augment>::insert(Node_handle&& handle) {
+    if (handle.empty()) {
+        return false;
     }
 
-    ++size;
+    size_t depth;
+    Node** link = find_insert_link(handle.node->key, depth);
+    if (link == nullptr) {
+        return false;
+    }
+
+    Node* node;
+    if (handle.owner == arena) {
+        node = handle.release();
+    } else {
+        node = arena->create(std::move(handle.node->key), std::move(handle.node->data));
+        handle.reset();
+    }
 
+    attach_node(link, node, depth);
     return true;
 }
 
-template <typename Key, typename Data>
-bool BST<Key, Data>::remove(const Key& key) {
-    Node *current = root;
-    Node *parent = nullptr;
+template <typename Key, typename Data, typename Augment>
+bool BST<Key, Data, Augment>::splice(BST& source, const Key& key) {
+    if (&source == this || locate(key) != nullptr) {
+        return false;
+    }
 
-    // Поиск удаляемого узла
-    while (current != nullptr && current->key != key) {
-        parent = current;
+    return insert(source.extract(key));
+}
 
-        if (key < current->key) {
-            current = current->left;
-        } else {
-            current = current->right;
-        }
+template <typename Key, typename Data, typename Augment>
+size_t BST<Key, Data, Augment>::merge(BST& source) {
+    if (&source == this || source.root == nullptr) {
+        return 0;
     }
 
-    if (current == nullptr) { // элемента с заданным ключом не существует
-        return false;
+    // деревья вытягиваются и перестраиваются, только если есть что переносить
+    bool any_missing = false;
+    for (Node* node = source.next_node(nullptr); node != nullptr; node = source.next_node(&node->key)) {
+        if (locate(node->key) == nullptr) {
+            any_missing = true;
+            break;
+        }
+    }
+    if (!any_missing) {
+        return 0;
     }
 
-    // У удаляемого узла нет детей (это лист дерева)
-    if (current->left == nullptr && current->right == nullptr) {
-        if (current == root) {
-            root = nullptr;
-        } else if (current == parent->left) {
-            parent->left = nullptr;
-        } else {
-            parent->right = nullptr;
+    bool shared = (source.arena == arena);
+    flatten(root);
+    flatten(source.root);
+
+    // слияние двух упорядоченных лоз: узлы с уже имеющимися ключами остаются в source
+    Node* mine = root;
+    Node* theirs = source.root;
+    Node* merged = nullptr;
+    Node** merged_tail = &merged;
+    Node* kept = nullptr;
+    Node** kept_tail = &kept;
+    size_t moved = 0;
+
+    while (theirs != nullptr) {
+        if (mine != nullptr && !(theirs->key < mine->key)) {
+            if (!(mine->key < theirs->key)) { // ключи равны
+                Node* next = theirs->right;
+                *kept_tail = theirs;
+                kept_tail = &theirs->right;
+                theirs = next;
+            }
+            *merged_tail = mine;
+            merged_tail = &mine->right;
+            mine = mine->right;
+            continue;
+        }
+
+        Node* next = theirs->right;
+        Node* node = theirs;
+        if (!shared) {
+            node = arena->create(std::move(theirs->key), std::move(theirs->data));
+            source.destroy_node(theirs);
         }
 
-        delete current;
+        *merged_tail = node;
+        merged_tail = &node->right;
+        theirs = next;
+        ++moved;
     }
+    *merged_tail = mine;
+    *kept_tail = nullptr;
 
-    // У удаляемого узла есть один дочерний узел
-    else if (current->left == nullptr) { // левый дочерний узел
-        if (current == root) {
-            root = current->right;
-        } else if (current == parent->left) {
-            parent->left = current->right;
-        } else {
-            parent->right = current->right;
-        }
+    root = merged;
+    size += moved;
+    source.root = kept;
+    source.size -= moved;
+
+    // кэш источника мог указывать на перенесённые узлы
+    std::fill(source.cache.begin(), source.cache.end(), nullptr);
 
-        delete current;
+    rebalance();
+    max_size = size;
+    source.rebalance();
+    source.max_size = source.size;
+
+    // фильтры перестраиваются по готовым деревьям: посреди слияния обход от корня видит не все узлы
+    if (moved > 0 && filter.is_enabled()) {
+        rebuild_filter(2 * size);
+    }
+    if (moved > 0 && source.filter.is_enabled()) {
+        source.rebuild_filter(2 * source.size);
     }
 
-    else if (current->right == nullptr) { // правый дочерний узел
-        if (current == root) {
-            root = current->left;
-        } else if (current == parent->left) {
-            parent->left = current->left;
-        } else {
-            parent->right = current->left;
-        }
+    return moved;
+}
 
-        delete current;
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::share_node_arena(BST& other) {
+    if (root != nullptr) {
+        throw Array_exception("Cannot share node arena of a non-empty tree");
+    }
+    if (other.compacting) {
+        throw Array_exception("Cannot share node arena of a tree being compacted");
     }
 
-    // У удаляемого узла два дочерних узла
-    else {
-        Node *successor = current->right;
-        Node *successor_parent = current;
+    // дерево опустело посреди уплотнения: извлечённые узлы уже перенесены, старое поколение свободно
+    if (compacting) {
+        finish_compaction();
+    }
 
-        // Ищем приемника узла (это узел с минимальным ключом в правом поддереве)
-        while (successor->left != nullptr) {
-            successor_parent = successor;
-            successor = successor->left;
+    arena = other.arena;
+}
+
+template <typename Key, typename Data, typename Augment>
+typename BST<Key, Data, Augment>::Node** BST<Key, Data, Augment>::find_insert_link(const Key& key, size_t& depth) {
+    Node** link = &root;
+    depth = 0;
+    insert_path.clear();
+
+    while (*link != nullptr) { // ищем место вставки
+        Node* current = *link;
+        if (key == current->key) { // дубликаты запрещены
+            return nullptr;
         }
 
-        // Копируем приемника в удаляемый узел
-        current->key = successor->key;
-        current->data = successor->data;
+        if (balance_alpha > 0 || is_augmented) {
+            insert_path.push_back(link);
+        }
 
-        // Удаляем приемника
-        if (successor == successor_parent->left) {
-            successor_parent->left = nullptr;
+        if (key < current->key) {
+            link = &current->left;
         } else {
-            successor_parent->right = nullptr;
+            link = &current->right;
         }
-
-        delete successor;
+        ++depth;
     }
 
-    --size;
-    return true;
+    return link;
 }
 
-template <typename Key, typename Data>
-void BST<Key, Data>::clear() {
-    if (root == nullptr) {
-        return;
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::attach_node(Node** link, Node* node, size_t depth) {
+    *link = node; // создаем связь родителя с новым узлом
+    ++size;
+    filter_add(node->key);
+
+    if constexpr (is_augmented) {
+        pull(node);
+        pull_insert_path(); // перестройка козла отпущения не меняет агрегаты над поддеревом
     }
 
-    std::stack<Node*> node_stack;
-    node_stack.push(root);
+    if (balance_alpha > 0) {
+        max_size = std::max(max_size, size);
+        if (depth > alpha_height(size)) {
+            rebuild_scapegoat(node);
+        }
+    }
+}
 
-    while (!node_stack.empty()) {
-        Node* current = node_stack.top();
+template <typename Key, typename Data, typename Augment>
+bool BST<Key, Data, Augment>::insert(const Key& key, const Data& data) {
+    size_t depth;
+    Node** link = find_insert_link(key, depth);
+    if (link == nullptr) {
+        return false;
+    }
+
+    attach_node(link, create_node(key, data), depth);
+    return true;
+}
+
+template <typename Key, typename Data, typename Augment>
+size_t BST<Key, Data, Augment>::alpha_height(size_t count) const {
+    return static_cast<size_t>(std::log(static_cast<double>(count)) / log_inverse_alpha);
+}
+
+template <typename Key, typename Data, typename Augment>
+size_t BST<Key, Data, Augment>::subtree_size(Node* node) {
+    if (node == nullptr) {
+        return 0;
+    }
+
+    size_t count = 0;
+    std::vector<Node*> node_stack;
+    node_stack.push_back(node);
+
+    while (!node_stack.empty()) {
+        Node* current = node_stack.back();
+        node_stack.pop_back();
+        ++count;
+
+        if (current->left != nullptr) {
+            node_stack.push_back(current->left);
+        }
+        if (current->right != nullptr) {
+            node_stack.push_back(current->right);
+        }
+    }
+
+    return count;
+}
+
+template <typename Key, typename Data, typename Augment>
+typename BST<Key, Data, Augment>::Node* BST<Key, Data, Augment>::link_balanced(Node** nodes, size_t count) {
+    if (count == 0) {
+        return nullptr;
+    }
+
+    size_t middle = count / 2;
+    Node* node = nodes[middle];
+    node->left = link_balanced(nodes, middle);
+    node->right = link_balanced(nodes + middle + 1, count - middle - 1);
+    pull(node);
+
+    return node;
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::rebuild_subtree(Node*& link, size_t count) {
+    // выписываем узлы поддерева в порядке L -> t -> R и связываем их заново
+    std::vector<Node*> nodes;
+    nodes.reserve(count);
+
+    std::vector<Node*> parent_stack;
+    Node* current = link;
+    while (!parent_stack.empty() || current != nullptr) {
+        if (current != nullptr) {
+            parent_stack.push_back(current);
+            current = current->left;
+        } else {
+            current = parent_stack.back();
+            parent_stack.pop_back();
+            nodes.push_back(current);
+            current = current->right;
+        }
+    }
+
+    link = link_balanced(nodes.data(), nodes.size());
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::rebuild_scapegoat(Node* inserted) {
+    // поднимаемся от нового узла, пока не найдём предка, у которого один из потомков
+    // содержит больше alpha узлов его поддерева
+    Node* child = inserted;
+    size_t child_size = 1;
+
+    for (size_t i = insert_path.size(); i-- > 0;) {
+        Node* node = *insert_path[i];
+        Node* sibling = (node->left == child) ? node->right : node->left;
+        size_t node_size = child_size + 1 + subtree_size(sibling);
+
+        if (static_cast<double>(child_size) > balance_alpha * static_cast<double>(node_size)) {
+            rebuild_subtree(*insert_path[i], node_size);
+            return;
+        }
+
+        child = node;
+        child_size = node_size;
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+typename BST<Key, Data, Augment>::Node* BST<Key, Data, Augment>::relocate(Node** link) {
+    Node* old_node = *link;
+    Node* new_node = arena->create(std::move(old_node->key), std::move(old_node->data));
+    new_node->left = old_node->left;
+    new_node->right = old_node->right;
+    new_node->summary = old_node->summary;
+    *link = new_node;
+
+    if (!cache.empty()) {
+        size_t slot = cache_slot(new_node->key);
+        if (cache[slot] == old_node) {
+            cache[slot] = new_node;
+        }
+    }
+
+    arena->destroy(old_node);
+    return new_node;
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::compact(Compact_layout layout) {
+    check_arena_exclusive();
+    compacting = false;
+    compact_cursor.reset();
+    compact_path.clear();
+
+    if (root == nullptr) {
+        arena->release_all();
+        return;
+    }
+
+    arena->begin_generation(size);
+
+    if (layout == Compact_layout::breadth_first) {
+        // очередь ссылок: узел переносится в момент извлечения, то есть по уровням
+        std::queue<Node**> links;
+        links.push(&root);
+
+        while (!links.empty()) {
+            Node* node = relocate(links.front());
+            links.pop();
+
+            if (node->left != nullptr) {
+                links.push(&node->left);
+            }
+            if (node->right != nullptr) {
+                links.push(&node->right);
+            }
+        }
+    } else {
+        // симметричный обход по ссылкам: узел переносится, когда его левое поддерево пройдено
+        std::vector<Node**> parent_links;
+        Node** link = &root;
+
+        while (!parent_links.empty() || *link != nullptr) {
+            if (*link != nullptr) {
+                parent_links.push_back(link);
+                link = &(*link)->left;
+            } else {
+                Node* node = relocate(parent_links.back());
+                parent_links.pop_back();
+                link = &node->right;
+            }
+        }
+    }
+
+    arena->release_retired();
+}
+
+template <typename Key, typename Data, typename Augment>
+bool BST<Key, Data, Augment>::compact_step(size_t budget) {
+    if (!compacting) {
+        if (root == nullptr) {
+            return true;
+        }
+        check_arena_exclusive();
+
+        // запас на вставки между шагами, чтобы они тоже легли в новый блок
+        arena->begin_generation(size + size / 8 + 16);
+        compacting = true;
+        compact_cursor.reset();
+    }
+
+    // восстанавливаем путь к первому узлу с ключом больше курсора: дерево могло измениться
+    compact_path.clear();
+    Node** link = &root;
+    while (*link != nullptr) {
+        if (!compact_cursor.has_value() || *compact_cursor < (*link)->key) {
+            compact_path.push_back(link);
+            link = &(*link)->left;
+        } else {
+            link = &(*link)->right;
+        }
+    }
+
+    for (size_t visited = 0; visited < budget && !compact_path.empty(); ++visited) {
+        Node** current = compact_path.back();
+        compact_path.pop_back();
+
+        Node* node = *current;
+        if (!arena->owns(node)) { // вставленные между шагами узлы уже в новом поколении
+            node = relocate(current);
+        }
+        compact_cursor = node->key;
+
+        for (Node** left = &node->right; *left != nullptr; left = &(*left)->left) {
+            compact_path.push_back(left);
+        }
+    }
+
+    if (!compact_path.empty()) {
+        return false;
+    }
+
+    finish_compaction();
+    return true;
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::finish_compaction() {
+    arena->release_retired();
+    compacting = false;
+    compact_cursor.reset();
+    compact_path.clear();
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::enable_scapegoat(double alpha) {
+    if (alpha != 0 && (alpha <= 0.5 || alpha >= 1)) {
+        throw Array_exception("Scapegoat alpha must be in (0.5, 1)");
+    }
+
+    balance_alpha = alpha;
+    insert_path.clear();
+
+    if (alpha == 0) {
+        log_inverse_alpha = 0;
+        max_size = 0;
+        return;
+    }
+
+    log_inverse_alpha = std::log(1.0 / alpha);
+    rebalance();
+    max_size = size;
+}
+
+template <typename Key, typename Data, typename Augment>
+typename BST<Key, Data, Augment>::Summary BST<Key, Data, Augment>::summary_of(Node* node) {
+    if constexpr (is_augmented) {
+        return node == nullptr ? Augment::identity() : node->summary;
+    } else {
+        return Summary();
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::pull(Node* node) {
+    if constexpr (is_augmented) {
+        node->summary = Augment::combine(Augment::combine(summary_of(node->left), Augment::lift(node->key, node->data)),
+                                         summary_of(node->right));
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::pull_subtree(Node* node) {
+    if constexpr (is_augmented) {
+        if (node == nullptr) {
+            return;
+        }
+
+        // обратный обход L -> R -> t: потомки пересчитываются раньше родителя
+        std::vector<std::pair<Node*, bool>> node_stack;
+        node_stack.push_back(std::make_pair(node, false));
+
+        while (!node_stack.empty()) {
+            Node* current = node_stack.back().first;
+            if (node_stack.back().second) {
+                node_stack.pop_back();
+                pull(current);
+                continue;
+            }
+
+            node_stack.back().second = true;
+            if (current->right != nullptr) {
+                node_stack.push_back(std::make_pair(current->right, false));
+            }
+            if (current->left != nullptr) {
+                node_stack.push_back(std::make_pair(current->left, false));
+            }
+        }
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::pull_insert_path() {
+    for (size_t i = insert_path.size(); i-- > 0;) {
+        pull(*insert_path[i]);
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+bool BST<Key, Data, Augment>::update(const Key& key, const Data& data) {
+    Node* current = root;
+    update_path.clear();
+
+    while (current != nullptr && current->key != key) {
+        update_path.push_back(current);
+        if (key < current->key) {
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+
+    if (current == nullptr) {
+        return false;
+    }
+
+    current->data = data;
+
+    if constexpr (is_augmented) {
+        pull(current);
+        for (size_t i = update_path.size(); i-- > 0;) {
+            pull(update_path[i]);
+        }
+    }
+
+    return true;
+}
+
+template <typename Key, typename Data, typename Augment>
+typename BST<Key, Data, Augment>::Summary BST<Key, Data, Augment>::aggregate(const Key& lo, const Key& hi) const {
+    static_assert(is_augmented, "aggregate() requires an augmented BST");
+
+    // спускаемся до узла, в котором пути к lo и hi расходятся
+    Node* split = root;
+    while (split != nullptr && (split->key < lo || hi < split->key)) {
+        split = (split->key < lo) ? split->right : split->left;
+    }
+
+    if (split == nullptr) {
+        return Augment::identity();
+    }
+
+    // левая граница: узлы с ключами >= lo и их правые поддеревья, справа налево
+    Summary left_part = Augment::identity();
+    for (Node* current = split->left; current != nullptr;) {
+        if (current->key < lo) {
+            current = current->right;
+        } else {
+            left_part = Augment::combine(Augment::combine(Augment::lift(current->key, current->data),
+                                                          summary_of(current->right)), left_part);
+            current = current->left;
+        }
+    }
+
+    // правая граница: левые поддеревья и узлы с ключами <= hi, слева направо
+    Summary right_part = Augment::identity();
+    for (Node* current = split->right; current != nullptr;) {
+        if (hi < current->key) {
+            current = current->left;
+        } else {
+            right_part = Augment::combine(right_part, Augment::combine(summary_of(current->left),
+                                                                       Augment::lift(current->key, current->data)));
+            current = current->right;
+        }
+    }
+
+    return Augment::combine(Augment::combine(left_part, Augment::lift(split->key, split->data)), right_part);
+}
+
+template <typename Key, typename Data, typename Augment>
+typename BST<Key, Data, Augment>::Summary BST<Key, Data, Augment>::get_summary() const {
+    static_assert(is_augmented, "get_summary() requires an augmented BST");
+
+    return summary_of(root);
+}
+
+template <typename Key, typename Data, typename Augment>
+template <typename Descend, typename Visit>
+void BST<Key, Data, Augment>::visit_where(Descend descend, Visit visit) const {
+    static_assert(is_augmented, "visit_where() requires an augmented BST");
+
+    // симметричный обход, в который не заходят поддеревья с ложным предикатом
+    std::vector<Node*> parent_stack;
+    Node* current = root;
+
+    while (!parent_stack.empty() || current != nullptr) {
+        if (current != nullptr) {
+            if (descend(current->summary)) {
+                parent_stack.push_back(current);
+                current = current->left;
+            } else {
+                current = nullptr;
+            }
+        } else {
+            current = parent_stack.back();
+            parent_stack.pop_back();
+            if (descend(Augment::lift(current->key, current->data))) {
+                visit(current->key, current->data);
+            }
+            current = current->right;
+        }
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+template <typename Visit>
+void BST<Key, Data, Augment>::visit_in_order(Visit visit) const {
+    std::vector<Node*> parent_stack;
+    Node* current = root;
+
+    while (!parent_stack.empty() || current != nullptr) {
+        if (current != nullptr) {
+            parent_stack.push_back(current);
+            current = current->left;
+        } else {
+            current = parent_stack.back();
+            parent_stack.pop_back();
+            visit(current->key, static_cast<const Data&>(current->data));
+            current = current->right;
+        }
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+typename BST<Key, Data, Augment>::Summary BST<Key, Data, Augment>::summary_between(const Key* lo, const Key* hi) const {
+    auto above_lo = [lo](const Key& key) { return lo == nullptr || *lo < key; };
+    auto below_hi = [hi](const Key& key) { return hi == nullptr || key < *hi; };
+
+    // как в aggregate(), но границы не входят в диапазон
+    Node* split = root;
+    while (split != nullptr && !(above_lo(split->key) && below_hi(split->key))) {
+        split = above_lo(split->key) ? split->left : split->right;
+    }
+
+    if (split == nullptr) {
+        return Augment::identity();
+    }
+
+    Summary left_part = Augment::identity();
+    for (Node* current = split->left; current != nullptr;) {
+        if (!above_lo(current->key)) {
+            current = current->right;
+        } else {
+            left_part = Augment::combine(Augment::combine(Augment::lift(current->key, current->data),
+                                                          summary_of(current->right)), left_part);
+            current = current->left;
+        }
+    }
+
+    Summary right_part = Augment::identity();
+    for (Node* current = split->right; current != nullptr;) {
+        if (!below_hi(current->key)) {
+            current = current->left;
+        } else {
+            right_part = Augment::combine(right_part, Augment::combine(summary_of(current->left),
+                                                                       Augment::lift(current->key, current->data)));
+            current = current->right;
+        }
+    }
+
+    return Augment::combine(Augment::combine(left_part, Augment::lift(split->key, split->data)), right_part);
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::collect_between(Node* start, const Key* lo, const Key* hi, std::vector<Key>& keys) {
+    // симметричный обход, не заходящий в поддеревья за границами
+    std::vector<Node*> parent_stack;
+    Node* current = start;
+
+    while (!parent_stack.empty() || current != nullptr) {
+        if (current != nullptr) {
+            if (lo != nullptr && !(*lo < current->key)) {
+                current = current->right;
+            } else if (hi != nullptr && !(current->key < *hi)) {
+                current = current->left;
+            } else {
+                parent_stack.push_back(current);
+                current = current->left;
+            }
+        } else {
+            current = parent_stack.back();
+            parent_stack.pop_back();
+            keys.push_back(current->key);
+            current = current->right;
+        }
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+std::vector<Key> BST<Key, Data, Augment>::diff(const BST& other) const {
+    static_assert(is_augmented, "diff() requires an augmented BST");
+
+    // Поддерево узла node содержит все ключи дерева строго между lo и hi. Если путь к узлу
+    // в другом дереве проходит по тем же ключам, узел mirror другого дерева покрывает тот же
+    // диапазон, и его агрегат берётся за O(1), иначе агрегат диапазона считается по other.
+    struct Frame {
+        Node* node;
+        const Key* lo;
+        const Key* hi;
+        Node* mirror;
+        bool mirrored;   // mirror покрывает тот же диапазон (nullptr - в other диапазон пуст)
+        bool check_node; // сравнить сам узел, а не поддерево
+    };
+
+    std::vector<Key> keys;
+    std::vector<Frame> frames;
+    frames.push_back(Frame{ root, nullptr, nullptr, other.root, true, false });
+
+    while (!frames.empty()) {
+        Frame frame = frames.back();
+        frames.pop_back();
+        Node* node = frame.node;
+
+        if (frame.check_node) {
+            Node* match = frame.mirror;
+            if (match == nullptr || match->key != node->key) {
+                match = other.locate(node->key);
+            }
+            if (match == nullptr || !(match->data == node->data)) {
+                keys.push_back(node->key);
+            }
+            continue;
+        }
+
+        Summary theirs = frame.mirrored ? summary_of(frame.mirror) : other.summary_between(frame.lo, frame.hi);
+        if (summary_of(node) == theirs) {
+            continue;
+        }
+
+        if (node == nullptr) { // все ключи other из диапазона отсутствуют в этом дереве
+            collect_between(frame.mirrored ? frame.mirror : other.root, frame.lo, frame.hi, keys);
+            continue;
+        }
+
+        bool same_split = frame.mirrored && frame.mirror != nullptr && frame.mirror->key == node->key;
+        Node* mirror_left = same_split ? frame.mirror->left : nullptr;
+        Node* mirror_right = same_split ? frame.mirror->right : nullptr;
+
+        // стек: сначала левое поддерево, затем узел, затем правое - ключи выходят по возрастанию
+        frames.push_back(Frame{ node->right, &node->key, frame.hi, mirror_right, same_split, false });
+        frames.push_back(Frame{ node, frame.lo, frame.hi, same_split ? frame.mirror : nullptr, false, true });
+        frames.push_back(Frame{ node->left, frame.lo, &node->key, mirror_left, same_split, false });
+    }
+
+    return keys;
+}
+
+namespace bst_delta {
+    constexpr uint64_t magic = 0x31544c4544545342ull; // "BSTDELT1"
+    constexpr uint8_t op_erase = 0;
+    constexpr uint8_t op_put = 1;
+
+    template<typename T>
+    void write_raw(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    void read_raw(std::istream& in, T& value) {
+        if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+            throw Array_exception("Delta is truncated");
+        }
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+size_t BST<Key, Data, Augment>::write_delta(const BST& base, std::ostream& out) const {
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Data>
+                  && std::is_trivially_copyable_v<Summary>, "Delta stores keys, data and summaries as raw bytes");
+
+    std::vector<Key> keys = diff(base);
+
+    bst_delta::write_raw(out, bst_delta::magic);
+    bst_delta::write_raw(out, static_cast<uint64_t>(keys.size()));
+    bst_delta::write_raw(out, base.get_summary());
+    bst_delta::write_raw(out, get_summary());
+
+    for (const Key& key : keys) {
+        Node* node = locate(key);
+        if (node != nullptr) {
+            bst_delta::write_raw(out, bst_delta::op_put);
+            bst_delta::write_raw(out, key);
+            bst_delta::write_raw(out, node->data);
+        } else {
+            bst_delta::write_raw(out, bst_delta::op_erase);
+            bst_delta::write_raw(out, key);
+        }
+    }
+
+    out.flush();
+    return keys.size();
+}
+
+template <typename Key, typename Data, typename Augment>
+size_t BST<Key, Data, Augment>::apply_delta(std::istream& in) {
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Data>
+                  && std::is_trivially_copyable_v<Summary>, "Delta stores keys, data and summaries as raw bytes");
+
+    uint64_t magic = 0;
+    uint64_t count = 0;
+    Summary base = Augment::identity();
+    Summary target = Augment::identity();
+    bst_delta::read_raw(in, magic);
+    if (magic != bst_delta::magic) {
+        throw Array_exception("Not a BST delta");
+    }
+    bst_delta::read_raw(in, count);
+    bst_delta::read_raw(in, base);
+    bst_delta::read_raw(in, target);
+
+    if (!(get_summary() == base)) {
+        throw Array_exception("Delta was written for a different tree");
+    }
+
+    // изменения читаются целиком до применения: обрезанный поток не оставляет дерево наполовину изменённым
+    std::vector<std::pair<Key, std::optional<Data>>> changes;
+    changes.reserve(static_cast<size_t>(std::min<uint64_t>(count, 4096))); // count ещё не проверен
+    for (uint64_t i = 0; i < count; ++i) {
+        uint8_t op = 0;
+        Key key{};
+        bst_delta::read_raw(in, op);
+        bst_delta::read_raw(in, key);
+
+        if (op == bst_delta::op_put) {
+            Data data{};
+            bst_delta::read_raw(in, data);
+            changes.emplace_back(key, data);
+        } else if (op == bst_delta::op_erase) {
+            changes.emplace_back(key, std::nullopt);
+        } else {
+            throw Array_exception("Delta is corrupted");
+        }
+    }
+
+    for (const auto& change : changes) {
+        if (!change.second.has_value()) {
+            remove(change.first);
+        } else if (!update(change.first, *change.second)) {
+            insert(change.first, *change.second);
+        }
+    }
+
+    if (!(get_summary() == target)) {
+        throw Array_exception("Delta is corrupted");
+    }
+
+    return changes.size();
+}
+
+template <typename Key, typename Data, typename Augment>
+typename BST<Key, Data, Augment>::Node* BST<Key, Data, Augment>::build_balanced(const std::pair<Key, Data>* items, size_t count) {
+    if (count == 0) {
+        return nullptr;
+    }
+
+    size_t middle = count / 2;
+    Node* node = create_node(items[middle].first, items[middle].second);
+    node->left = build_balanced(items, middle);
+    node->right = build_balanced(items + middle + 1, count - middle - 1);
+    pull(node);
+
+    return node;
+}
+
+template <typename Key, typename Data, typename Augment>
+size_t BST<Key, Data, Augment>::insert_sorted(const std::vector<std::pair<Key, Data>>& items) {
+    // неупорядоченная группа подвесилась бы поддеревом с нарушенным порядком ключей;
+    // границы группы с ключами дерева обеспечивает спуск: она ложится между соседями в дереве
+    for (size_t k = 1; k < items.size(); ++k) {
+        if (!(items[k - 1].first < items[k].first)) {
+            throw Array_exception("Keys of a sorted batch must be strictly increasing");
+        }
+    }
+
+    size_t inserted = 0;
+    size_t max_depth = 0; // наибольшая глубина подвешенных узлов
+    size_t i = 0;
+
+    while (i < items.size()) {
+        const Key& key = items[i].first;
+        Node** slot = &root;
+        const Key* upper = nullptr; // ближайший ключ дерева, больший key
+        size_t depth = 0;
+        bool exists = false;
+        insert_path.clear();
+
+        while (*slot != nullptr) { // ищем место вставки
+            ++depth;
+            Node* current = *slot;
+            if constexpr (is_augmented) {
+                insert_path.push_back(slot);
+            }
+            if (key == current->key) {
+                exists = true;
+                break;
+            } else if (key < current->key) {
+                upper = &current->key;
+                slot = &current->left;
+            } else {
+                slot = &current->right;
+            }
+        }
+
+        if (exists) { // дубликаты запрещены
+            ++i;
+            continue;
+        }
+
+        // все следующие ключи меньше upper попадают в то же свободное место
+        size_t j = i + 1;
+        while (j < items.size() && (upper == nullptr || items[j].first < *upper)) {
+            ++j;
+        }
+
+        *slot = build_balanced(&items[i], j - i);
+        inserted += j - i;
+        size += j - i;
+
+        if (filter.is_enabled()) {
+            if (filter.get_key_count() + (j - i) > filter.get_capacity(filter_bits_per_key)) {
+                rebuild_filter(2 * size); // перестроенный фильтр уже содержит подвешенную группу
+            } else {
+                for (size_t k = i; k < j; ++k) {
+                    filter.add(key_hash(items[k].first));
+                }
+            }
+        }
+        if constexpr (is_augmented) {
+            pull_insert_path();
+        }
+
+        size_t group_height = 0;
+        for (size_t group = j - i; group > 0; group /= 2) {
+            ++group_height;
+        }
+        max_depth = std::max(max_depth, depth + group_height - 1);
+
+        i = j;
+    }
+
+    if (balance_alpha > 0 && inserted > 0) {
+        max_size = std::max(max_size, size);
+        if (max_depth > alpha_height(size)) {
+            rebalance();
+        }
+    }
+
+    return inserted;
+}
+
+template <typename Key, typename Data, typename Augment>
+typename BST<Key, Data, Augment>::Node* BST<Key, Data, Augment>::detach_node(const Key& key) {
+    Node** link = &root;
+    update_path.clear();
+
+    // Поиск удаляемого узла
+    while (*link != nullptr && (*link)->key != key) {
+        if constexpr (is_augmented) {
+            update_path.push_back(*link);
+        }
+
+        if (key < (*link)->key) {
+            link = &(*link)->left;
+        } else {
+            link = &(*link)->right;
+        }
+    }
+
+    if (*link == nullptr) { // элемента с заданным ключом не существует
+        return nullptr;
+    }
+
+    // узел уходит из дерева, а старое поколение будет освобождено: переносим его заранее
+    if (compacting && !arena->owns(*link)) {
+        relocate(link);
+    }
+
+    Node* current = *link;
+    cache_forget(key);
+
+    if (current->left == nullptr) { // нет левого потомка: поднимаем правое поддерево
+        *link = current->right;
+    } else if (current->right == nullptr) { // нет правого потомка: поднимаем левое поддерево
+        *link = current->left;
+    } else { // два потомка: на место узла встаёт приемник
+        size_t current_index = update_path.size();
+        if constexpr (is_augmented) {
+            update_path.push_back(current);
+        }
+
+        // Ищем приемника узла (это узел с минимальным ключом в правом поддереве)
+        Node** successor_link = &current->right;
+        while ((*successor_link)->left != nullptr) {
+            if constexpr (is_augmented) {
+                update_path.push_back(*successor_link);
+            }
+            successor_link = &(*successor_link)->left;
+        }
+
+        // Вынимаем приемника (левого потомка у него нет, правое поддерево поднимается на его место)
+        Node* successor = *successor_link;
+        *successor_link = successor->right;
+
+        successor->left = current->left;
+        successor->right = current->right;
+        *link = successor;
+
+        if constexpr (is_augmented) {
+            update_path[current_index] = successor;
+        }
+    }
+
+    current->left = nullptr;
+    current->right = nullptr;
+    --size;
+    filter_remove();
+
+    if constexpr (is_augmented) { // агрегаты меняются только на пути от корня до удалённого узла
+        for (size_t i = update_path.size(); i-- > 0;) {
+            pull(update_path[i]);
+        }
+    }
+
+    if (balance_alpha > 0 && static_cast<double>(size) < balance_alpha * static_cast<double>(max_size)) {
+        rebalance();
+        max_size = size;
+    }
+
+    return current;
+}
+
+template <typename Key, typename Data, typename Augment>
+bool BST<Key, Data, Augment>::remove(const Key& key) {
+    Node* node = detach_node(key);
+    if (node == nullptr) {
+        return false;
+    }
+
+    destroy_node(node);
+    return true;
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::clear() {
+    if (root == nullptr) {
+        return;
+    }
+
+    std::stack<Node*> node_stack;
+    node_stack.push(root);
+
+    while (!node_stack.empty()) {
+        Node* current = node_stack.top();
         node_stack.pop();
 
         if (current->left != nullptr) {
@@ -491,23 +1970,58 @@ void BST<Key, Data>::clear() {
             node_stack.push(current->right);
         }
 
-        delete current;
+        destroy_node(current);
     }
 
     size = 0;
     root = nullptr;
+    max_size = 0;
+    if (arena.use_count() == 1) { // блоки разделяемого распределителя ещё заняты чужими узлами
+        arena->release_all();
+    }
+    if (compacting) {
+        finish_compaction();
+    }
+    filter.reset();
+    filter_removed = 0;
+
+    std::fill(cache.begin(), cache.end(), nullptr);
 }
 
-template <typename Key, typename Data>
-typename BST<Key, Data>::Node* BST<Key, Data>::find_node(const Key& key) const {
-    if (root == nullptr) {
-        throw Array_exception("BST is empty");
+template <typename Key, typename Data, typename Augment>
+uint64_t BST<Key, Data, Augment>::key_hash(const Key& key) {
+    if constexpr (key_is_hashable) {
+        return static_cast<uint64_t>(std::hash<Key>{}(key));
+    } else {
+        return 0;
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+typename BST<Key, Data, Augment>::Node* BST<Key, Data, Augment>::search(const Key& key) const {
+    if (filter.is_enabled() && !filter.may_contain(key_hash(key))) { // ключа точно нет
+        ++filter_rejects;
+        return nullptr;
+    }
+
+    size_t slot = 0;
+    if (!cache.empty()) {
+        slot = cache_slot(key);
+        Node* cached = cache[slot];
+        if (cached != nullptr && cached->key == key) {
+            ++cache_hits;
+            return cached;
+        }
+        ++cache_misses;
     }
 
     Node* current = root;
 
     while (current != nullptr) { // Поиск узла с заданным ключом
         if (current->key == key) {
+            if (!cache.empty()) {
+                cache[slot] = current;
+            }
             return current;
         } else if (key < current->key) {
             current = current->left;
@@ -516,57 +2030,457 @@ typename BST<Key, Data>::Node* BST<Key, Data>::find_node(const Key& key) const {
         }
     }
 
-    throw Array_exception("No such key in BST");
+    if (filter.is_enabled()) {
+        ++filter_false_positives;
+    }
+
+    return nullptr;
+}
+
+template <typename Key, typename Data, typename Augment>
+typename BST<Key, Data, Augment>::Node* BST<Key, Data, Augment>::locate(const Key& key) const {
+    Node* current = root;
+
+    while (current != nullptr && current->key != key) {
+        if (key < current->key) {
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+
+    return current;
+}
+
+template <typename Key, typename Data, typename Augment>
+typename BST<Key, Data, Augment>::Node* BST<Key, Data, Augment>::next_node(const Key* key) const {
+    Node* current = root;
+    Node* next = nullptr;
+
+    while (current != nullptr) {
+        if (key == nullptr || *key < current->key) {
+            next = current;
+            current = current->left;
+        } else {
+            current = current->right;
+        }
+    }
+
+    return next;
+}
+
+template <typename Key, typename Data, typename Augment>
+typename BST<Key, Data, Augment>::Node* BST<Key, Data, Augment>::find_node(const Key& key) const {
+    if (root == nullptr) {
+        throw Array_exception("BST is empty");
+    }
+
+    Node* node = search(key);
+    if (node == nullptr) {
+        throw Array_exception("No such key in BST");
+    }
+
+    return node;
+}
+
+template <typename Key, typename Data, typename Augment>
+size_t BST<Key, Data, Augment>::cache_slot(const Key& key) const {
+    if constexpr (key_is_hashable) {
+        // мультипликативное хэширование: старшие биты произведения равномерно распределены
+        uint64_t h = key_hash(key) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h >> cache_shift);
+    } else {
+        return 0;
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::cache_forget(const Key& key) {
+    if (cache.empty()) {
+        return;
+    }
+
+    size_t slot = cache_slot(key);
+    if (cache[slot] != nullptr && cache[slot]->key == key) {
+        cache[slot] = nullptr;
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::enable_cache(size_t slots) {
+    if (slots > 0 && !key_is_hashable) {
+        throw Array_exception("Key type is not hashable");
+    }
+
+    cache_hits = 0;
+    cache_misses = 0;
+
+    if (slots == 0) {
+        cache.clear();
+        cache.shrink_to_fit();
+        return;
+    }
+
+    // не меньше двух слотов: при bits == 0 сдвиг на 64 был бы неопределён
+    size_t capacity = 2;
+    int bits = 1;
+    while (capacity < slots) {
+        capacity <<= 1;
+        ++bits;
+    }
+
+    cache.assign(capacity, nullptr);
+    cache_shift = 64 - bits;
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::enable_filter(size_t expected_keys, size_t bits_per_key) {
+    if (bits_per_key > 0 && !key_is_hashable) {
+        throw Array_exception("Key type is not hashable");
+    }
+
+    filter_rejects = 0;
+    filter_false_positives = 0;
+    filter_bits_per_key = bits_per_key;
+
+    if (bits_per_key == 0) {
+        filter = Blocked_bloom_filter();
+        return;
+    }
+
+    rebuild_filter(std::max(expected_keys, size));
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::rebuild_filter(size_t capacity) {
+    filter = Blocked_bloom_filter(std::max<size_t>(capacity, 64), filter_bits_per_key);
+    filter_removed = 0;
+
+    std::vector<Node*> node_stack;
+    if (root != nullptr) {
+        node_stack.push_back(root);
+    }
+
+    while (!node_stack.empty()) {
+        Node* current = node_stack.back();
+        node_stack.pop_back();
+        filter.add(key_hash(current->key));
+
+        if (current->left != nullptr) {
+            node_stack.push_back(current->left);
+        }
+        if (current->right != nullptr) {
+            node_stack.push_back(current->right);
+        }
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::filter_add(const Key& key) {
+    if (!filter.is_enabled()) {
+        return;
+    }
+
+    if (filter.get_key_count() >= filter.get_capacity(filter_bits_per_key)) { // переполнение: растём вдвое
+        rebuild_filter(2 * size);
+    } else {
+        filter.add(key_hash(key));
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::filter_remove() {
+    if (!filter.is_enabled()) {
+        return;
+    }
+
+    // удалённые ключи остаются в фильтре и повышают долю ложных срабатываний
+    ++filter_removed;
+    if (2 * filter_removed >= filter.get_key_count()) {
+        rebuild_filter(2 * size);
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+Filter_stats BST<Key, Data, Augment>::get_filter_stats() const {
+    Filter_stats stats;
+    if (!filter.is_enabled()) {
+        return stats;
+    }
+
+    stats.memory_bytes = filter.get_memory();
+    stats.capacity = filter.get_capacity(filter_bits_per_key);
+    stats.keys = filter.get_key_count();
+    stats.estimated_fpr = filter.estimated_fpr();
+    stats.rejects = filter_rejects;
+    stats.false_positives = filter_false_positives;
+    if (filter_rejects + filter_false_positives > 0) {
+        stats.observed_fpr = static_cast<double>(filter_false_positives)
+                             / static_cast<double>(filter_rejects + filter_false_positives);
+    }
+
+    return stats;
 }
 
-template <typename Key, typename Data>
-Data& BST<Key, Data>::operator[](const Key& key) {
+template <typename Key, typename Data, typename Augment>
+Data& BST<Key, Data, Augment>::operator[](const Key& key) {
     return find_node(key)->data;
 }
 
-template <typename Key, typename Data>
-const Data& BST<Key, Data>::operator[](const Key& key) const {
+template <typename Key, typename Data, typename Augment>
+const Data& BST<Key, Data, Augment>::operator[](const Key& key) const {
     return find_node(key)->data;
 }
 
-template <typename Key, typename Data>
-Data& BST<Key, Data>::at(const Key& key) {
+template <typename Key, typename Data, typename Augment>
+Data& BST<Key, Data, Augment>::at(const Key& key) {
     return (*this)[key];
 }
 
-template <typename Key, typename Data>
-const Data& BST<Key, Data>::at(const Key& key) const {
+template <typename Key, typename Data, typename Augment>
+const Data& BST<Key, Data, Augment>::at(const Key& key) const {
     return (*this)[key];
 }
 
-template <typename Key, typename Data>
-void BST<Key, Data>::show(Node* current, int level) const {
-    if (current == nullptr) {
-        return;
+template <typename Key, typename Data, typename Augment>
+template <typename T>
+void BST<Key, Data, Augment>::write_label(Buffered_writer& writer, const T& value) {
+    if constexpr (std::is_same_v<T, char>) {
+        writer.write_escaped(std::string_view(&value, 1));
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        writer.write_value(value);
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        writer.write_escaped(std::string_view(value));
+    } else {
+        std::ostringstream text;
+        text << value;
+        writer.write_escaped(text.str());
+    }
+}
+
+template <typename Key, typename Data, typename Augment>
+template <typename T>
+void BST<Key, Data, Augment>::write_json_value(Buffered_writer& writer, const T& value) {
+    if constexpr (std::is_floating_point_v<T>) {
+        if (std::isfinite(value)) {
+            writer.write_value(value);
+        } else {
+            writer.write("null"); // в JSON нет NaN и бесконечностей
+        }
+    } else if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, char>) {
+        writer.write_value(value);
+    } else {
+        writer.put('"');
+        write_label(writer, value);
+        writer.put('"');
+    }
+}
+
+// Обход R -> t -> L с явным стеком: глубина дерева не ограничена размером стека вызовов
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::dump_text(Node* start, Buffered_writer& writer, const Dump_options& options) const {
+    std::vector<std::pair<Node*, size_t>> parent_stack;
+    Node* current = start;
+    size_t level = 0;
+    size_t printed = 0;
+
+    auto indent = [&writer, &options](size_t depth) {
+        if (depth <= options.max_indent) {
+            writer.indent(depth);
+        } else {
+            writer.indent(options.max_indent);
+            writer.put('[');
+            writer.write_value(depth);
+            writer.write("] ");
+        }
+    };
+
+    while (!parent_stack.empty() || current != nullptr) {
+        if (current != nullptr) {
+            if (level >= options.max_depth) { // поддерево не выводится
+                indent(level);
+                writer.write("...\n");
+                current = nullptr;
+                continue;
+            }
+
+            parent_stack.push_back(std::make_pair(current, level));
+            current = current->right;
+            ++level;
+        } else {
+            if (printed == options.max_nodes) {
+                writer.write("...\n");
+                return;
+            }
+
+            current = parent_stack.back().first;
+            level = parent_stack.back().second;
+            parent_stack.pop_back();
+
+            // ключ и данные - как в прежнем print_tree() через operator<<
+            indent(level);
+            writer.write_as_stream(current->key);
+            writer.put(' ');
+            writer.write_as_stream(current->data);
+            writer.put('\n');
+            ++printed;
+
+            current = current->left;
+            ++level;
+        }
+    }
+}
+
+// Прямой обход: узел описывается до своих потомков, рёбра ведут от родителя
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::dump_dot(Node* start, Buffered_writer& writer, const Dump_options& options) const {
+    struct Frame {
+        Node* node;
+        size_t level;
+        size_t parent_id; // 0 - нет родителя
+    };
+
+    writer.write("digraph BST {\n");
+
+    std::vector<Frame> node_stack;
+    if (start != nullptr) {
+        node_stack.push_back(Frame{ start, 0, 0 });
+    }
+
+    size_t next_id = 1;
+    size_t printed = 0;
+
+    while (!node_stack.empty()) {
+        Frame frame = node_stack.back();
+        node_stack.pop_back();
+
+        if (printed == options.max_nodes) {
+            writer.write("  // truncated\n");
+            break;
+        }
+
+        size_t id = next_id++;
+        writer.write("  n");
+        writer.write_value(id);
+
+        if (frame.level >= options.max_depth) {
+            writer.write(" [label=\"...\", shape=plaintext];\n");
+        } else {
+            writer.write(" [label=\"");
+            write_label(writer, frame.node->key);
+            writer.write(": ");
+            write_label(writer, frame.node->data);
+            writer.write("\"];\n");
+            ++printed;
+
+            if (frame.node->right != nullptr) {
+                node_stack.push_back(Frame{ frame.node->right, frame.level + 1, id });
+            }
+            if (frame.node->left != nullptr) {
+                node_stack.push_back(Frame{ frame.node->left, frame.level + 1, id });
+            }
+        }
+
+        if (frame.parent_id != 0) {
+            writer.write("  n");
+            writer.write_value(frame.parent_id);
+            writer.write(" -> n");
+            writer.write_value(id);
+            writer.write(";\n");
+        }
     }
 
-    show(current->right, level + 1);
+    writer.write("}\n");
+}
+
+// Вложенные объекты выводятся конечным автоматом: 0 - начало узла, 1 - между потомками, 2 - конец
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::dump_json(Node* start, Buffered_writer& writer, const Dump_options& options) const {
+    struct Frame {
+        Node* node;
+        size_t level;
+        int stage;
+    };
+
+    std::vector<Frame> node_stack;
+    node_stack.push_back(Frame{ start, 0, 0 });
+    size_t printed = 0;
+
+    while (!node_stack.empty()) {
+        Frame& frame = node_stack.back();
+        Node* node = frame.node;
+        size_t level = frame.level;
+
+        if (node == nullptr) {
+            writer.write("null");
+            node_stack.pop_back();
+        } else if (frame.stage == 0 && (level >= options.max_depth || printed == options.max_nodes)) {
+            writer.write("\"...\"");
+            node_stack.pop_back();
+        } else if (frame.stage == 0) {
+            writer.write("{\"key\":");
+            write_json_value(writer, node->key);
+            writer.write(",\"data\":");
+            write_json_value(writer, node->data);
+            writer.write(",\"left\":");
+            ++printed;
+
+            frame.stage = 1;
+            node_stack.push_back(Frame{ node->left, level + 1, 0 });
+        } else if (frame.stage == 1) {
+            writer.write(",\"right\":");
+
+            frame.stage = 2;
+            node_stack.push_back(Frame{ node->right, level + 1, 0 });
+        } else {
+            writer.put('}');
+            node_stack.pop_back();
+        }
+    }
+
+    writer.put('\n');
+}
 
-    for (int i = 0; i < level; ++i) {
-        std::cout << "  ";
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::dump_from(Node* start, std::ostream& out, const Dump_options& options) const {
+    Buffered_writer writer(out);
+
+    switch (options.format) {
+    case Dump_format::dot:
+        dump_dot(start, writer, options);
+        break;
+    case Dump_format::json:
+        dump_json(start, writer, options);
+        break;
+    default:
+        dump_text(start, writer, options);
     }
 
-    std::cout << current->key << " " << current->data << std::endl;
+    writer.flush();
+    out.flush();
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::dump(std::ostream& out, const Dump_options& options) const {
+    dump_from(root, out, options);
+}
 
-    show(current->left, level + 1);
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::dump_subtree(const Key& key, std::ostream& out, const Dump_options& options) const {
+    dump_from(find_node(key), out, options);
 }
 
-template <typename Key, typename Data>
-void BST<Key, Data>::print_tree() const {
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::print_tree() const {
     if (root == nullptr) {
         std::cout << "Tree is empty" << std::endl;
     }
 
-    show(root, 0);
+    dump(std::cout);
 }
 
-template <typename Key, typename Data>
-std::vector <Key> BST<Key, Data>::get_keys() const {
+template <typename Key, typename Data, typename Augment>
+std::vector <Key> BST<Key, Data, Augment>::get_keys() const {
     std::vector <Key> keys;
 
     if (root == nullptr) {
@@ -593,8 +2507,8 @@ std::vector <Key> BST<Key, Data>::get_keys() const {
 
 // Внешним  узлом является узел с одним сыном или без сыновей
 // Длина внешнего пути  – сумма уровней всех внешних узлов дерева
-template <typename Key, typename Data>
-size_t BST<Key, Data>::get_external_path_length() const {
+template <typename Key, typename Data, typename Augment>
+size_t BST<Key, Data, Augment>::get_external_path_length() const {
     if (root == nullptr) {
         return 0;
     }
@@ -624,4 +2538,150 @@ size_t BST<Key, Data>::get_external_path_length() const {
     return path_length;
 }
 
+template <typename Key, typename Data, typename Augment>
+Tree_stats BST<Key, Data, Augment>::analyze() const {
+    Tree_stats stats;
+
+    if (root == nullptr) {
+        return stats;
+    }
+
+    struct Frame {
+        Node* node;
+        size_t level;
+        bool expanded; // потомки уже добавлены в стек
+    };
+
+    std::vector<Frame> node_stack;
+    std::vector<size_t> heights; // высоты обработанных поддеревьев (обратный обход L -> R -> t)
+    node_stack.push_back(Frame{ root, 0, false });
+
+    while (!node_stack.empty()) {
+        Frame& frame = node_stack.back();
+        Node* node = frame.node;
+        size_t level = frame.level;
+
+        if (!frame.expanded) {
+            frame.expanded = true;
+
+            ++stats.nodes;
+            stats.internal_path_length += level;
+            if (stats.depth_histogram.size() <= level) {
+                stats.depth_histogram.resize(level + 1, 0);
+            }
+            ++stats.depth_histogram[level];
+
+            if (node->left == nullptr && node->right == nullptr) {
+                stats.external_path_length += level;
+            }
+
+            // левое поддерево обрабатывается первым, его высота окажется в стеке ниже
+            if (node->right != nullptr) {
+                node_stack.push_back(Frame{ node->right, level + 1, false });
+            }
+            if (node->left != nullptr) {
+                node_stack.push_back(Frame{ node->left, level + 1, false });
+            }
+        } else {
+            size_t right_height = 0;
+            size_t left_height = 0;
+            if (node->right != nullptr) {
+                right_height = heights.back();
+                heights.pop_back();
+            }
+            if (node->left != nullptr) {
+                left_height = heights.back();
+                heights.pop_back();
+            }
+
+            size_t imbalance = left_height > right_height ? left_height - right_height : right_height - left_height;
+            if (stats.imbalance_histogram.size() <= imbalance) {
+                stats.imbalance_histogram.resize(imbalance + 1, 0);
+            }
+            ++stats.imbalance_histogram[imbalance];
+
+            heights.push_back(std::max(left_height, right_height) + 1);
+            node_stack.pop_back();
+        }
+    }
+
+    stats.height = heights.back();
+
+    double n = static_cast<double>(stats.nodes);
+    stats.average_search_depth = static_cast<double>(stats.internal_path_length) / n + 1;
+    // пустых ссылок n + 1, сумма их глубин равна internal_path_length + 2n
+    stats.miss_search_depth = (static_cast<double>(stats.internal_path_length) + 2 * n) / (n + 1);
+
+    // в идеально сбалансированном дереве на уровне d (кроме последнего) 2^d узлов
+    double optimal_comparisons = 0;
+    size_t remaining = stats.nodes;
+    size_t level_size = 1;
+    for (size_t level = 1; remaining > 0; ++level) {
+        size_t on_level = std::min(level_size, remaining);
+        optimal_comparisons += static_cast<double>(on_level) * static_cast<double>(level);
+        remaining -= on_level;
+        level_size *= 2;
+    }
+    stats.optimal_search_depth = optimal_comparisons / n;
+    stats.degeneration = stats.average_search_depth / stats.optimal_search_depth;
+
+    return stats;
+}
+
+template <typename Key, typename Data, typename Augment>
+size_t BST<Key, Data, Augment>::flatten(Node*& start) {
+    size_t count = 0;
+    Node** link = &start;
+    while (*link != nullptr) {
+        Node* current = *link;
+        if (current->left != nullptr) {
+            Node* left = current->left;
+            current->left = left->right;
+            left->right = current;
+            *link = left;
+        } else {
+            ++count;
+            link = &current->right;
+        }
+    }
+    return count;
+}
+
+template <typename Key, typename Data, typename Augment>
+void BST<Key, Data, Augment>::rebalance() {
+    if (root == nullptr) {
+        return;
+    }
+
+    // 1. Правыми поворотами вытягиваем дерево в "лозу" - цепочку правых потомков
+    size_t count = flatten(root);
+
+    // 2. Серией левых поворотов через узел сворачиваем лозу в сбалансированное дерево
+    auto compress = [this](size_t rotations) {
+        Node** link = &root;
+        for (size_t i = 0; i < rotations; ++i) {
+            Node* current = *link;
+            Node* child = current->right;
+            current->right = child->left;
+            child->left = current;
+            *link = child;
+            link = &child->right;
+        }
+    };
+
+    size_t full = 1; // наибольшее 2^k - 1, не превосходящее count
+    while (full * 2 + 1 <= count) {
+        full = full * 2 + 1;
+    }
+
+    compress(count - full); // узлы неполного последнего уровня
+    while (full > 1) {
+        full /= 2;
+        compress(full);
+    }
+
+    // повороты лозы меняют форму всего дерева, агрегаты проще пересчитать одним обходом
+    pull_subtree(root);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+
+#include "../art.h"
+#include "../array_exception.h"
+
+TEST (ART, insert_and_at) {
+    ART<int> tree;
+    EXPECT_TRUE(tree.is_empty());
+    EXPECT_THROW(tree.at("a"), Array_exception);
+
+    EXPECT_TRUE(tree.insert("/usr/bin", 1));
+    EXPECT_TRUE(tree.insert("/usr/lib", 2));
+    EXPECT_TRUE(tree.insert("/usr", 3));
+    EXPECT_TRUE(tree.insert("/usr/bin/env", 4));
+    EXPECT_TRUE(tree.insert("", 5));
+    EXPECT_FALSE(tree.insert("/usr/lib", 20));
+
+    EXPECT_EQ(tree.get_size(), 5);
+    EXPECT_EQ(tree.at("/usr/bin"), 1);
+    EXPECT_EQ(tree.at("/usr/lib"), 2);
+    EXPECT_EQ(tree["/usr"], 3);
+    EXPECT_EQ(tree.at("/usr/bin/env"), 4);
+    EXPECT_EQ(tree.at(""), 5);
+    EXPECT_THROW(tree.at("/us"), Array_exception);
+    EXPECT_THROW(tree.at("/usr/bin/"), Array_exception);
+    EXPECT_THROW(tree.at("/usr/lib64"), Array_exception);
+
+    tree["/usr"] = 30;
+    const ART<int>& ctree = tree;
+    EXPECT_EQ(ctree.at("/usr"), 30);
+}
+
+TEST (ART, node_growth_and_shrink) {
+    ART<int> tree;
+    for (int byte = 0; byte < 256; ++byte) { // все значения байта, включая '\0'
+        std::string key = "k";
+        key.push_back(static_cast<char>(byte));
+        EXPECT_TRUE(tree.insert(key, byte));
+    }
+    EXPECT_EQ(tree.get_size(), 256);
+
+    for (int byte = 0; byte < 256; ++byte) {
+        std::string key = "k";
+        key.push_back(static_cast<char>(byte));
+        EXPECT_EQ(tree.at(key), byte);
+    }
+
+    for (int byte = 0; byte < 255; ++byte) {
+        std::string key = "k";
+        key.push_back(static_cast<char>(byte));
+        EXPECT_TRUE(tree.remove(key));
+        EXPECT_FALSE(tree.remove(key));
+    }
+    EXPECT_EQ(tree.get_size(), 1);
+    EXPECT_EQ(tree.at(std::string("k\xff")), 255);
+}
+
+TEST (ART, ordered_iteration) {
+    ART<int> tree;
+    std::vector<std::string> keys = { "b", "a", "abc", "ab", "", "abd", "\xff", "z" };
+    for (size_t i = 0; i < keys.size(); ++i) {
+        tree.insert(keys[i], static_cast<int>(i));
+    }
+
+    std::vector<std::string> expected = { "", "a", "ab", "abc", "abd", "b", "z", "\xff" };
+    EXPECT_EQ(tree.get_keys(), expected);
+
+    ART<int>::Iterator it = tree.begin();
+    EXPECT_EQ(it.key(), "");
+    EXPECT_EQ(*it, 4);
+    ++it;
+    EXPECT_EQ(it.key(), "a");
+    EXPECT_EQ(*it, 1);
+
+    ART<int> empty;
+    EXPECT_EQ(empty.begin(), empty.end());
+    EXPECT_THROW(*empty.begin(), Array_exception);
+}
+
+TEST (ART, matches_std_map) {
+    std::mt19937 random(2024);
+    std::uniform_int_distribution<int> length_dist(0, 6);
+    std::uniform_int_distribution<int> char_dist(0, 3);
+    std::uniform_int_distribution<int> op_dist(0, 2);
+
+    ART<int> tree;
+    std::map<std::string, int> expected;
+
+    for (int i = 0; i < 30000; ++i) {
+        std::string key;
+        int length = length_dist(random);
+        for (int j = 0; j < length; ++j) {
+            key.push_back(static_cast<char>("/ab\x90"[char_dist(random)]));
+        }
+
+        if (op_dist(random) == 0) {
+            EXPECT_EQ(tree.remove(key), expected.erase(key) == 1);
+        } else {
+            EXPECT_EQ(tree.insert(key, i), expected.emplace(key, i).second);
+        }
+    }
+
+    EXPECT_EQ(tree.get_size(), expected.size());
+    std::vector<std::string> keys = tree.get_keys();
+    ASSERT_EQ(keys.size(), expected.size());
+
+    size_t i = 0;
+    for (const auto& item : expected) {
+        EXPECT_EQ(keys[i++], item.first);
+        EXPECT_EQ(tree.at(item.first), item.second);
+    }
+
+    tree.clear();
+    EXPECT_TRUE(tree.is_empty());
+    EXPECT_FALSE(tree.contains(keys.empty() ? "" : keys[0]));
+}
+
+// Данные, копирование которых можно заставить бросить исключение.
+struct Throwing_data {
+    static inline bool armed = false;
+    int value = 0;
+
+    explicit Throwing_data(int v) : value(v) {}
+    Throwing_data(const Throwing_data& other) : value(other.value) {
+        if (armed) {
+            throw Array_exception("Copy failed");
+        }
+    }
+};
+
+TEST (ART, failed_insert_leaves_tree_intact) {
+    ART<Throwing_data> tree;
+    std::vector<std::string> keys = { "apple", "apricot", "banana" };
+    for (size_t i = 0; i < keys.size(); ++i) {
+        tree.insert(keys[i], Throwing_data(static_cast<int>(i)));
+    }
+
+    // расщепление листа ("banana" / "band"), разрез сжатого пути ("ap" / "ax"),
+    // ключ внутри пути ("a") и новый потомок узла
+    Throwing_data::armed = true;
+    for (const char* key : { "band", "ax", "a", "c", "apples" }) {
+        EXPECT_THROW(tree.insert(key, Throwing_data(-1)), Array_exception);
+    }
+    Throwing_data::armed = false;
+
+    EXPECT_EQ(tree.get_size(), keys.size());
+    EXPECT_EQ(tree.get_keys(), keys);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_EQ(tree.at(keys[i]).value, static_cast<int>(i));
+    }
+    EXPECT_FALSE(tree.contains("band"));
+    EXPECT_TRUE(tree.insert("band", Throwing_data(7)));
+    EXPECT_EQ(tree.at("banana").value, 2);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+
+#include "../bloom_filter.h"
+#include "../tree.h"
+#include "../array_exception.h"
+
+TEST (Blocked_bloom_filter, no_false_negatives) {
+    Blocked_bloom_filter filter(10000, 10);
+    EXPECT_TRUE(filter.is_enabled());
+    EXPECT_EQ(filter.get_memory() % 64, 0);
+
+    for (uint64_t key = 0; key < 10000; ++key) {
+        filter.add(key);
+    }
+    for (uint64_t key = 0; key < 10000; ++key) {
+        EXPECT_TRUE(filter.may_contain(key));
+    }
+
+    size_t false_positives = 0;
+    for (uint64_t key = 10000; key < 110000; ++key) {
+        false_positives += filter.may_contain(key) ? 1 : 0;
+    }
+    double fpr = static_cast<double>(false_positives) / 100000;
+    EXPECT_LT(fpr, 0.03);
+    EXPECT_NEAR(fpr, filter.estimated_fpr(), 0.02);
+
+    filter.reset();
+    EXPECT_EQ(filter.get_key_count(), 0);
+    EXPECT_FALSE(Blocked_bloom_filter().is_enabled());
+}
+
+TEST (BST, filter_rejects_misses) {
+    BST<int, int> tree;
+    tree.enable_filter(1000);
+
+    for (int key = 0; key < 5000; key += 2) { // фильтр переполняется и растёт
+        tree.insert(key, key);
+    }
+
+    for (int key = 0; key < 5000; ++key) {
+        EXPECT_EQ(tree.contains(key), key % 2 == 0);
+    }
+    EXPECT_EQ(tree.at(42), 42);
+    EXPECT_THROW(tree.at(43), Array_exception);
+
+    Filter_stats stats = tree.get_filter_stats();
+    EXPECT_GE(stats.capacity, 2500);
+    EXPECT_GT(stats.memory_bytes, 0);
+    EXPECT_EQ(stats.rejects + stats.false_positives, 2501);
+    EXPECT_LT(stats.observed_fpr, 0.05);
+
+    tree.enable_filter(0, 0);
+    EXPECT_EQ(tree.get_filter_stats().memory_bytes, 0);
+    EXPECT_FALSE(tree.contains(43));
+}
+
+TEST (BST, filter_remove_churn) {
+    std::mt19937 random(3);
+    std::uniform_int_distribution<int> key_dist(0, 20000);
+
+    BST<int, int> tree;
+    tree.enable_filter(0, 12);
+    std::set<int> expected;
+
+    for (int i = 0; i < 30000; ++i) {
+        int key = key_dist(random);
+        if (i % 2 == 0) {
+            EXPECT_EQ(tree.insert(key, key), expected.insert(key).second);
+        } else {
+            EXPECT_EQ(tree.remove(key), expected.erase(key) == 1);
+        }
+    }
+
+    for (int key = 0; key <= 20000; ++key) {
+        EXPECT_EQ(tree.contains(key), expected.count(key) == 1);
+    }
+
+    // после перестроек удалённые ключи не накапливаются в фильтре
+    Filter_stats stats = tree.get_filter_stats();
+    EXPECT_LE(stats.keys, 2 * expected.size() + 1);
+
+    std::vector<std::pair<int, int>> batch;
+    for (int key = 30000; key < 40000; ++key) {
+        batch.emplace_back(key, key);
+    }
+    tree.insert_sorted(batch);
+    EXPECT_TRUE(tree.contains(35000));
+    EXPECT_FALSE(tree.contains(40001));
+
+    BST<int, int> copy(tree);
+    EXPECT_TRUE(copy.contains(39999));
+    tree.clear();
+    EXPECT_FALSE(tree.contains(39999));
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+
+#include "../tree.h"
+#include "../buffered_tree.h"
+#include "../array_exception.h"
+
+TEST (BST, insert_sorted_test) {
+    BST<int, int> tree;
+    tree.insert(10, 10);
+    tree.insert(20, 20);
+
+    std::vector<std::pair<int, int>> items = { {1, 1}, {2, 2}, {10, 100}, {15, 15}, {16, 16}, {30, 30} };
+    EXPECT_EQ(tree.insert_sorted(items), 5);
+    EXPECT_EQ(tree.get_size(), 7);
+    EXPECT_EQ(tree.at(10), 10); // существующий ключ не перезаписан
+    EXPECT_EQ(tree.at(16), 16);
+
+    std::vector<int> keys = tree.get_keys();
+    std::vector<int> expected = { 1, 2, 10, 15, 16, 20, 30 };
+    EXPECT_EQ(keys, expected);
+}
+
+TEST (BST, insert_sorted_rejects_unsorted) {
+    BST<int, int> tree;
+    tree.insert(10, 10);
+    tree.insert(20, 20);
+
+    // 5 после 12 попал бы в поддерево между 10 и 20
+    std::vector<std::pair<int, int>> unsorted = { {11, 11}, {12, 12}, {5, 5} };
+    EXPECT_THROW(tree.insert_sorted(unsorted), Array_exception);
+    std::vector<std::pair<int, int>> repeated = { {1, 1}, {3, 3}, {3, 30} };
+    EXPECT_THROW(tree.insert_sorted(repeated), Array_exception);
+
+    EXPECT_EQ(tree.get_size(), 2);
+    EXPECT_EQ(tree.get_keys(), (std::vector<int>{ 10, 20 }));
+
+    std::vector<std::pair<int, int>> empty;
+    EXPECT_EQ(tree.insert_sorted(empty), 0);
+}
+
+TEST (BST, remove_successor_with_right_child) {
+    BST<int, int> tree;
+    for (int key : { 5, 3, 9, 7, 8 }) {
+        tree.insert(key, key);
+    }
+
+    // приемник 7 узла 5 имеет правого потомка 8
+    EXPECT_TRUE(tree.remove(5));
+    EXPECT_EQ(tree.at(8), 8);
+    std::vector<int> expected = { 3, 7, 8, 9 };
+    EXPECT_EQ(tree.get_keys(), expected);
+}
+
+TEST (Buffered_BST, reads_see_pending_writes) {
+    Buffered_BST<int, int> tree(1000, 4);
+    tree.insert(1, 10);
+    tree.insert(2, 20);
+    EXPECT_EQ(tree.at(1), 10);
+    EXPECT_TRUE(tree.contains(2));
+    EXPECT_FALSE(tree.contains(3));
+    EXPECT_THROW(tree.at(3), Array_exception);
+
+    tree.insert(1, 11); // дубликат не перезаписывает значение
+    EXPECT_EQ(tree.at(1), 10);
+
+    tree.remove(1);
+    EXPECT_FALSE(tree.contains(1));
+    EXPECT_THROW(tree.at(1), Array_exception);
+
+    tree.insert(1, 12);
+    EXPECT_EQ(tree.at(1), 12);
+    EXPECT_GT(tree.get_pending(), 0);
+
+    EXPECT_EQ(tree.get_size(), 2);
+    EXPECT_EQ(tree.get_pending(), 0);
+    EXPECT_EQ(tree.at(1), 12);
+}
+
+TEST (Buffered_BST, pending_insert_of_existing_key) {
+    Buffered_BST<int, int> tree(1000, 4);
+    tree.insert(7, 70);
+    tree.flush();
+
+    tree.insert(7, 71);
+    EXPECT_EQ(tree.at(7), 70);
+    tree.at(7) = 72;
+    tree.flush();
+    EXPECT_EQ(tree.at(7), 72);
+}
+
+TEST (Buffered_BST, matches_std_map) {
+    std::mt19937 random(12345);
+    std::uniform_int_distribution<int> key_dist(0, 2000);
+    std::uniform_int_distribution<int> op_dist(0, 9);
+
+    Buffered_BST<int, int> tree(256, 8);
+    std::map<int, int> expected;
+
+    for (int i = 0; i < 20000; ++i) {
+        int key = key_dist(random);
+        int op = op_dist(random);
+        if (op < 6) {
+            tree.insert(key, i);
+            expected.emplace(key, i);
+        } else if (op < 8) {
+            tree.remove(key);
+            expected.erase(key);
+        } else {
+            auto it = expected.find(key);
+            if (it == expected.end()) {
+                EXPECT_FALSE(tree.contains(key));
+                EXPECT_THROW(tree.at(key), Array_exception);
+            } else {
+                EXPECT_EQ(tree.at(key), it->second);
+            }
+        }
+    }
+
+    EXPECT_EQ(tree.get_size(), expected.size());
+    std::vector<int> keys = tree.get_keys();
+    std::vector<int> expected_keys;
+    for (const auto& item : expected) {
+        expected_keys.push_back(item.first);
+        EXPECT_EQ(tree.at(item.first), item.second);
+    }
+    EXPECT_EQ(keys, expected_keys);
+}
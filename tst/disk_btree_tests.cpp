@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <random>
+#include <string>
+#include <csignal>
+#include <sys/resource.h>
+
+#include "../disk_btree.h"
+#include "../array_exception.h"
+
+// Чистый файл данных во временном каталоге; файл и журнал удаляются по завершении теста.
+struct Temp_file {
+    std::string path;
+
+    explicit Temp_file(const std::string& name)
+        : path((std::filesystem::temp_directory_path() / ("disk_btree_" + name + ".db")).string()) {
+        remove();
+    }
+
+    Temp_file(const Temp_file&) = delete;
+    Temp_file& operator=(const Temp_file&) = delete;
+
+    ~Temp_file() { remove(); }
+
+    void remove() const {
+        std::error_code error;
+        std::filesystem::remove_all(path, error);
+        std::filesystem::remove_all(path + ".wal", error);
+    }
+};
+
+// Число открытых файловых дескрипторов процесса.
+static size_t open_fd_count() {
+    size_t count = 0;
+    for ([[maybe_unused]] const auto& entry : std::filesystem::directory_iterator("/proc/self/fd")) {
+        ++count;
+    }
+    return count;
+}
+
+template<typename Key, typename Data>
+static void expect_equal(Disk_btree<Key, Data>& tree, const std::map<Key, Data>& expected) {
+    EXPECT_EQ(tree.get_size(), expected.size());
+
+    auto it = tree.begin();
+    for (const auto& [key, data] : expected) {
+        ASSERT_NE(it, tree.end());
+        EXPECT_EQ(it->first, key);
+        EXPECT_EQ(it->second, data);
+        ++it;
+    }
+    EXPECT_EQ(it, tree.end());
+}
+
+TEST (Disk_btree, insert_at_remove) {
+    Temp_file file("basic");
+    const std::string& path = file.path;
+    Disk_btree<int, double> tree(path);
+
+    EXPECT_TRUE(tree.is_empty());
+    EXPECT_THROW(tree.at(1), Array_exception);
+
+    EXPECT_TRUE(tree.insert(5, 0.5));
+    EXPECT_TRUE(tree.insert(1, 0.1));
+    EXPECT_TRUE(tree.insert(3, 0.3));
+    EXPECT_FALSE(tree.insert(3, 9.9));
+
+    EXPECT_EQ(tree.get_size(), 3);
+    EXPECT_EQ(tree.at(3), 0.3);
+    EXPECT_TRUE(tree.contains(5));
+    EXPECT_EQ(tree.get_keys(), std::vector<int>({ 1, 3, 5 }));
+
+    EXPECT_TRUE(tree.remove(3));
+    EXPECT_FALSE(tree.remove(3));
+    EXPECT_FALSE(tree.contains(3));
+    EXPECT_EQ(tree.get_keys(), std::vector<int>({ 1, 5 }));
+
+    tree.clear();
+    EXPECT_TRUE(tree.is_empty());
+    EXPECT_EQ(tree.begin(), tree.end());
+}
+
+TEST (Disk_btree, small_pool_matches_map_and_reopens) {
+    Temp_file file("reopen");
+    const std::string& path = file.path;
+    std::map<long long, long long> expected;
+    std::mt19937 random(11);
+    std::uniform_int_distribution<long long> key_dist(0, 1000000);
+
+    {
+        Disk_btree<long long, long long> tree(path, 16, 32); // рабочий набор много больше пула
+        for (int i = 0; i < 60000; ++i) {
+            long long key = key_dist(random);
+            if (i % 4 == 3) {
+                EXPECT_EQ(tree.remove(key), expected.erase(key) == 1);
+            } else {
+                EXPECT_EQ(tree.insert(key, key * 7), expected.emplace(key, key * 7).second);
+            }
+        }
+
+        expect_equal(tree, expected);
+        EXPECT_GT(tree.get_stats().evictions, 0);
+        EXPECT_GT(tree.get_stats().checkpoints, 0);
+    }
+
+    Disk_btree<long long, long long> reopened(path, 64);
+    expect_equal(reopened, expected);
+    for (int i = 0; i < 1000; ++i) {
+        long long key = key_dist(random);
+        auto found = expected.find(key);
+        if (found == expected.end()) {
+            EXPECT_THROW(reopened.at(key), Array_exception);
+        } else {
+            EXPECT_EQ(reopened.at(key), found->second);
+        }
+    }
+
+    EXPECT_THROW((Disk_btree<int, int>(path)), Array_exception); // другой формат записей
+}
+
+TEST (Disk_btree, crash_loses_only_uncommitted) {
+    Temp_file file("crash");
+    const std::string& path = file.path;
+    std::map<int, int> expected;
+
+    {
+        Disk_btree<int, int> tree(path, 4096, 1000000);
+        for (int key = 0; key < 20000; ++key) {
+            tree.insert(key * 3, key);
+            expected.emplace(key * 3, key);
+        }
+        tree.sync();
+
+        for (int key = 0; key < 500; ++key) { // не зафиксировано
+            tree.insert(key * 3 + 1, key);
+            tree.remove(key * 3);
+        }
+        tree.simulate_crash();
+    }
+
+    Disk_btree<int, int> recovered(path);
+    expect_equal(recovered, expected);
+}
+
+TEST (Disk_btree, crash_with_evicted_pages_and_torn_wal) {
+    Temp_file file("torn");
+    const std::string& path = file.path;
+    std::map<int, int> expected;
+    std::mt19937 random(23);
+    std::uniform_int_distribution<int> key_dist(0, 200000);
+
+    {
+        // маленький пул: зафиксированные страницы вытесняются в файл данных до контрольной точки
+        Disk_btree<int, int> tree(path, 16, 1000000);
+        for (int i = 0; i < 30000; ++i) {
+            int key = key_dist(random);
+            if (i % 5 == 4) {
+                tree.remove(key);
+                expected.erase(key);
+            } else {
+                tree.insert(key, i);
+                expected.emplace(key, i);
+            }
+        }
+        tree.sync();
+        EXPECT_GT(tree.get_stats().page_writes, 0);
+        tree.simulate_crash();
+    }
+
+    // сбой посреди записи следующего пакета: в журнале остался оборванный хвост
+    {
+        std::ofstream wal(path + ".wal", std::ios::binary | std::ios::app);
+        std::string garbage(5000, '\x5a');
+        wal.write("BLAW", 4);
+        wal.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+    }
+
+    Disk_btree<int, int> recovered(path, 32);
+    expect_equal(recovered, expected);
+
+    // после восстановления дерево продолжает работать
+    EXPECT_TRUE(recovered.insert(-1, -1));
+    EXPECT_EQ(recovered.at(-1), -1);
+}
+
+TEST (Disk_btree, failed_open_closes_data_file) {
+    Temp_file file("bad_wal");
+    std::filesystem::create_directory(file.path + ".wal"); // журнал нельзя открыть на запись
+
+    size_t before = open_fd_count();
+    EXPECT_THROW((Disk_btree<int, int>(file.path)), Array_exception);
+    EXPECT_EQ(open_fd_count(), before);
+}
+
+TEST (Disk_btree, failed_commit_keeps_last_committed_state) {
+    Temp_file file("failed_commit");
+    std::map<int, int> expected;
+    std::mt19937 random(31);
+    std::uniform_int_distribution<int> key_dist(0, 100000);
+
+    {
+        // весь рабочий набор в пуле: файл данных пишется только контрольной точкой
+        std::optional<Disk_btree<int, int>> holder;
+        Disk_btree<int, int>& tree = holder.emplace(file.path, 1024, 1000000);
+        for (int i = 0; i < 20000; ++i) {
+            int key = key_dist(random);
+            tree.insert(key, i);
+            expected.emplace(key, i);
+            if (i % 1000 == 999) {
+                tree.sync(); // каждый пакет содержит почти все листья
+            }
+        }
+        tree.sync();
+
+        for (int key = -500; key < 0; ++key) { // не будут зафиксированы
+            tree.insert(key, key);
+        }
+
+        // запись за пределом размера журнала не проходит, страницы файла данных лежат ниже предела
+        uintmax_t wal_size = std::filesystem::file_size(file.path + ".wal");
+        ASSERT_GT(wal_size, 2u << 20);
+        rlimit saved;
+        ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &saved), 0);
+        rlimit limited = saved;
+        limited.rlim_cur = static_cast<rlim_t>(wal_size);
+        auto saved_handler = std::signal(SIGXFSZ, SIG_IGN);
+        ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &limited), 0);
+
+        EXPECT_THROW(tree.sync(), Array_exception);
+
+        // деструктор снова пытается зафиксировать изменения, не может и не трогает файл данных
+        holder.reset();
+        setrlimit(RLIMIT_FSIZE, &saved);
+        std::signal(SIGXFSZ, saved_handler);
+    }
+
+    Disk_btree<int, int> recovered(file.path);
+    expect_equal(recovered, expected);
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+#include <type_traits>
+
+#include "../expiring_tree.h"
+#include "../array_exception.h"
+
+TEST (Expiring_BST, lookups_skip_expired) {
+    Expiring_BST<int, std::string> sessions;
+    EXPECT_TRUE(sessions.insert(1, "alice", 100, 0));
+    EXPECT_TRUE(sessions.insert(2, "bob", 50, 0));
+    EXPECT_FALSE(sessions.insert(1, "mallory", 200, 10)); // живой ключ не перезаписывается
+
+    EXPECT_EQ(sessions.at(2, 49), "bob");
+    EXPECT_FALSE(sessions.contains(2, 50));
+    EXPECT_THROW(sessions.at(2, 50), Array_exception);
+    EXPECT_EQ(sessions.get_size(), 2); // просроченный элемент ещё хранится
+    EXPECT_EQ(sessions.get_keys(60), std::vector<int>({ 1 }));
+
+    EXPECT_TRUE(sessions.insert(2, "carol", 300, 60)); // заменяет просроченный
+    EXPECT_EQ(sessions.at(2, 299), "carol");
+
+    EXPECT_TRUE(sessions.touch(1, 400, 99));
+    EXPECT_FALSE(sessions.touch(3, 400, 99));
+    EXPECT_EQ(sessions.expire_until(350), 1); // истекает только carol
+    EXPECT_EQ(sessions.at(1, 350), "alice");
+    EXPECT_FALSE(sessions.touch(1, 500, 400));
+
+    EXPECT_TRUE(sessions.remove(1));
+    EXPECT_FALSE(sessions.remove(1));
+    EXPECT_TRUE(sessions.is_empty());
+}
+
+TEST (Expiring_BST, bounded_batches) {
+    Expiring_BST<int, int> tree;
+    for (int key = 0; key < 1000; ++key) {
+        tree.insert(key, key, 1000 + key % 100, 0);
+    }
+
+    EXPECT_EQ(tree.expire_until(999), 0);
+    EXPECT_EQ(tree.expire_until(1009, 25), 25);
+    EXPECT_EQ(tree.expire_until(1009, 25), 25);
+    EXPECT_EQ(tree.expire_until(1009, 1000), 50);  // 10 моментов по 10 ключей
+    EXPECT_EQ(tree.expire_until(1009), 0);
+    EXPECT_EQ(tree.get_size(), 900);
+
+    for (int key : tree.get_keys(1009)) {
+        EXPECT_GE(key % 100, 10);
+    }
+}
+
+TEST (Expiring_BST, random_churn) {
+    std::mt19937 random(14);
+    std::uniform_int_distribution<int> key_dist(0, 3000);
+    std::uniform_int_distribution<int> ttl_dist(1, 200);
+
+    Expiring_BST<int, int> tree;
+    std::map<int, std::pair<int, int>> expected; // ключ -> (данные, момент истечения)
+
+    for (int now = 0; now < 20000; ++now) {
+        int key = key_dist(random);
+        auto it = expected.find(key);
+        bool live = it != expected.end() && now < it->second.second;
+
+        switch (now % 4) {
+        case 0:
+        case 1: {
+            int expires = now + ttl_dist(random);
+            EXPECT_EQ(tree.insert(key, now, expires, now), !live);
+            if (!live) {
+                expected[key] = { now, expires };
+            }
+            break;
+        }
+        case 2:
+            EXPECT_EQ(tree.touch(key, now + 100, now), live);
+            if (live) {
+                it->second.second = now + 100;
+            }
+            break;
+        default:
+            EXPECT_EQ(tree.contains(key, now), live);
+            if (live) {
+                EXPECT_EQ(tree.at(key, now), it->second.first);
+            }
+        }
+
+        if (now % 50 == 0) { // частичная очистка: часть просроченных остаётся до следующего раза
+            tree.expire_until(now, 16);
+        }
+    }
+
+    size_t live = 0;
+    for (const auto& item : expected) {
+        live += (20000 < item.second.second) ? 1 : 0;
+    }
+    tree.expire_until(20000);
+    EXPECT_EQ(tree.get_size(), live);
+    EXPECT_EQ(tree.get_keys(20000).size(), live);
+}
+
+TEST (Expiring_BST, move_keeps_expiry_index) {
+    static_assert(!std::is_copy_constructible_v<Expiring_BST<int, int>>);
+    static_assert(!std::is_copy_assignable_v<Expiring_BST<int, int>>);
+    static_assert(std::is_nothrow_move_constructible_v<Expiring_BST<int, int>>);
+    static_assert(std::is_nothrow_move_assignable_v<Expiring_BST<int, int>>);
+
+    Expiring_BST<int, int> source;
+    for (int key = 0; key < 100; ++key) {
+        source.insert(key, key, 100 + key, 0);
+    }
+
+    Expiring_BST<int, int> moved(std::move(source));
+    EXPECT_EQ(moved.get_size(), 100);
+    source = Expiring_BST<int, int>(); // после присваивания перемещённый контейнер снова пригоден к работе
+    source.insert(1, 1, 10, 0);
+    EXPECT_EQ(source.expire_until(10), 1);
+
+    EXPECT_TRUE(moved.touch(0, 500, 50)); // продление переставляет сроки в куче
+    EXPECT_EQ(moved.expire_until(150), 50); // ключи 1..50
+
+    Expiring_BST<int, int> assigned;
+    assigned.insert(-1, -1, 1000, 0);
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.get_size(), 50);
+    EXPECT_FALSE(assigned.contains(-1, 0));
+    EXPECT_EQ(assigned.expire_until(200), 49);
+    EXPECT_EQ(assigned.get_keys(200), std::vector<int>({ 0 }));
+}
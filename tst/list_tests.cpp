@@ -1,4 +1,12 @@
 #include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <set>
+#include <map>
 
 #include "../tree.h"
 #include "../array_exception.h"
@@ -357,6 +365,710 @@ TEST (BST, iterator_test5) {
     EXPECT_EQ(it, tree.begin());
 }
 
+TEST (BST, cache_hits_and_misses) {
+    BST<int, int> tree;
+    for (int i = 1; i < 10; ++i) {
+        tree.insert(i, i * 10);
+    }
+
+    tree.enable_cache(16);
+    EXPECT_EQ(tree.at(5), 50);
+    EXPECT_EQ(tree.get_cache_hits(), 0);
+    EXPECT_EQ(tree.get_cache_misses(), 1);
+
+    EXPECT_EQ(tree.at(5), 50);
+    EXPECT_EQ(tree[5], 50);
+    EXPECT_EQ(tree.get_cache_hits(), 2);
+    EXPECT_EQ(tree.get_cache_misses(), 1);
+
+    EXPECT_THROW(tree.at(100), Array_exception);
+    EXPECT_EQ(tree.get_cache_misses(), 2);
+}
+
+TEST (BST, cache_invalidation) {
+    BST<int, int> tree;
+    tree.insert(5, 5);
+    tree.insert(3, 3);
+    tree.insert(8, 8);
+    tree.insert(6, 6);
+    tree.insert(9, 9);
+    tree.enable_cache(4);
+
+    for (int key : {3, 5, 6, 8, 9}) {
+        EXPECT_EQ(tree.at(key), key);
+    }
+
+    // у узла 5 два потомка: его место занимает приемник 6
+    EXPECT_TRUE(tree.remove(5));
+    EXPECT_THROW(tree.at(5), Array_exception);
+    EXPECT_EQ(tree.at(6), 6);
+    EXPECT_EQ(tree.at(8), 8);
+
+    EXPECT_TRUE(tree.remove(8));
+    EXPECT_THROW(tree.at(8), Array_exception);
+    EXPECT_TRUE(tree.insert(8, 80));
+    EXPECT_EQ(tree.at(8), 80);
+
+    tree.clear();
+    EXPECT_THROW(tree.at(3), Array_exception);
+    tree.insert(3, 30);
+    EXPECT_EQ(tree.at(3), 30);
+}
+
+TEST (BST, cache_disabled) {
+    BST<int, int> tree;
+    tree.insert(1, 1);
+    tree.enable_cache(8);
+    tree.at(1);
+    tree.enable_cache(0);
+    EXPECT_EQ(tree.at(1), 1);
+    EXPECT_EQ(tree.get_cache_hits(), 0);
+    EXPECT_EQ(tree.get_cache_misses(), 0);
+}
+
+TEST (BST, cache_single_slot) {
+    BST<int, int> tree;
+    for (int i = 0; i < 16; ++i) {
+        tree.insert(i, i * 10);
+    }
+    tree.enable_cache(1);
+
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < 16; ++i) {
+            EXPECT_EQ(tree.at(i), i * 10);
+        }
+    }
+    EXPECT_EQ(tree.get_cache_hits() + tree.get_cache_misses(), 32);
+    tree.remove(3);
+    EXPECT_FALSE(tree.contains(3));
+}
+
+TEST (BST, dump_text) {
+    BST<int, int> tree;
+    tree.insert(2, 20);
+    tree.insert(1, 10);
+    tree.insert(3, 30);
+
+    std::ostringstream out;
+    tree.dump(out);
+    EXPECT_EQ(out.str(), "  3 30\n2 20\n  1 10\n");
+}
+
+TEST (BST, dump_dot) {
+    BST<int, std::string> tree;
+    tree.insert(2, "two");
+    tree.insert(1, "say \"one\"");
+
+    std::ostringstream out;
+    Dump_options options;
+    options.format = Dump_format::dot;
+    tree.dump(out, options);
+    EXPECT_EQ(out.str(), "digraph BST {\n"
+                         "  n1 [label=\"2: two\"];\n"
+                         "  n2 [label=\"1: say \\\"one\\\"\"];\n"
+                         "  n1 -> n2;\n"
+                         "}\n");
+}
+
+TEST (BST, dump_json) {
+    BST<std::string, int> tree;
+    tree.insert("b", 2);
+    tree.insert("c", 3);
+
+    std::ostringstream out;
+    Dump_options options;
+    options.format = Dump_format::json;
+    tree.dump(out, options);
+    EXPECT_EQ(out.str(), "{\"key\":\"b\",\"data\":2,\"left\":null,"
+                         "\"right\":{\"key\":\"c\",\"data\":3,\"left\":null,\"right\":null}}\n");
+
+    std::ostringstream empty_out;
+    BST<std::string, int>().dump(empty_out, options);
+    EXPECT_EQ(empty_out.str(), "null\n");
+}
+
+TEST (BST, dump_json_escapes_char_and_non_finite) {
+    BST<char, double> tree;
+    tree.insert('"', std::numeric_limits<double>::quiet_NaN());
+    tree.insert('\\', std::numeric_limits<double>::infinity());
+    tree.insert('\n', 1.5);
+
+    std::ostringstream out;
+    Dump_options options;
+    options.format = Dump_format::json;
+    tree.dump(out, options);
+    EXPECT_EQ(out.str(), "{\"key\":\"\\\"\",\"data\":null,"
+                         "\"left\":{\"key\":\"\\n\",\"data\":1.5,\"left\":null,\"right\":null},"
+                         "\"right\":{\"key\":\"\\\\\",\"data\":null,\"left\":null,\"right\":null}}\n");
+
+    BST<int, char> chars;
+    chars.insert(1, '\x01');
+    std::ostringstream char_out;
+    chars.dump(char_out, options);
+    EXPECT_EQ(char_out.str(), "{\"key\":1,\"data\":\"\\u0001\",\"left\":null,\"right\":null}\n");
+}
+
+TEST (BST, dump_limits) {
+    BST<int, int> tree;
+    for (int key : { 4, 2, 6, 1, 3, 5, 7 }) {
+        tree.insert(key, key);
+    }
+
+    std::ostringstream depth_out;
+    Dump_options options;
+    options.max_depth = 1;
+    tree.dump(depth_out, options);
+    EXPECT_EQ(depth_out.str(), "  ...\n4 4\n  ...\n");
+
+    std::ostringstream nodes_out;
+    options = Dump_options();
+    options.max_nodes = 2;
+    tree.dump(nodes_out, options);
+    EXPECT_EQ(nodes_out.str(), "    7 7\n  6 6\n...\n");
+
+    std::ostringstream subtree_out;
+    tree.dump_subtree(2, subtree_out);
+    EXPECT_EQ(subtree_out.str(), "  3 3\n2 2\n  1 1\n");
+    EXPECT_THROW(tree.dump_subtree(8, subtree_out), Array_exception);
+}
+
+TEST (BST, dump_degenerate_tree) {
+    const int count = 10000;
+    BST<int, int> tree;
+    for (int key = count; key > 0; --key) { // цепочка левых потомков
+        tree.insert(key, key);
+    }
+
+    std::ostringstream out;
+    tree.dump(out);
+    std::string text = out.str();
+    EXPECT_EQ(std::count(text.begin(), text.end(), '\n'), count);
+
+    Dump_options options;
+    options.format = Dump_format::json;
+    std::ostringstream json_out;
+    tree.dump(json_out, options);
+    EXPECT_EQ(json_out.str().back(), '\n');
+}
+
+TEST (BST, dump_text_caps_indentation) {
+    BST<int, int> tree;
+    for (int key = 40; key > 0; --key) {
+        tree.insert(key, key);
+    }
+
+    std::ostringstream out;
+    Dump_options options;
+    options.max_indent = 2;
+    options.max_nodes = 4;
+    tree.dump(out, options);
+    EXPECT_EQ(out.str(), "40 40\n  39 39\n    38 38\n    [3] 37 37\n...\n");
+}
+
+namespace {
+
+// Поток, который только считает символы и строки, не храня вывод.
+class Counting_buffer : public std::streambuf {
+public:
+    size_t chars = 0;
+    size_t lines = 0;
+
+protected:
+    int_type overflow(int_type c) override {
+        if (c != traits_type::eof()) {
+            ++chars;
+            lines += (c == '\n') ? 1 : 0;
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char* text, std::streamsize count) override {
+        chars += static_cast<size_t>(count);
+        lines += static_cast<size_t>(std::count(text, text + count, '\n'));
+        return count;
+    }
+};
+
+}
+
+TEST (BST, dump_degenerate_million) {
+    // цепочка левых потомков глубиной 15625, у каждого звена сбалансированное поддерево из 63 узлов:
+    // 10^6 узлов (цепочку длиной 10^6 через insert() пришлось бы строить O(n^2))
+    const int step = 64;
+    const int chain = 15625;
+    BST<int, int> tree;
+    for (int link = chain; link > 0; --link) {
+        tree.insert(link * step, 0);
+    }
+    std::vector<std::pair<int, int>> items;
+    for (int key = 1; key < chain * step; ++key) {
+        if (key % step != 0) {
+            items.emplace_back(key, 0);
+        }
+    }
+    tree.insert_sorted(items);
+    ASSERT_EQ(tree.get_size(), 1000000);
+
+    Counting_buffer buffer;
+    std::ostream out(&buffer);
+    tree.dump(out);
+    EXPECT_EQ(buffer.lines, 1000000);
+    EXPECT_LT(buffer.chars, 1000000u * 100); // отступ не больше max_indent уровней
+}
+
+TEST (BST, dump_text_stream_formatting) {
+    BST<double, bool> tree;
+    tree.insert(2.0 / 3, true);
+    tree.insert(0.25, false);
+
+    std::ostringstream out;
+    tree.dump(out);
+    EXPECT_EQ(out.str(), "0.666667 1\n  0.25 0\n");
+}
+
+TEST (BST, analyze_test) {
+    BST<int, int> tree;
+    EXPECT_EQ(tree.analyze().nodes, 0);
+
+    for (int key : { 5, 8, 3, 6, 7, 9, 4, 2, 1 }) {
+        tree.insert(key, key);
+    }
+
+    Tree_stats stats = tree.analyze();
+    EXPECT_EQ(stats.nodes, 9);
+    EXPECT_EQ(stats.height, 4);
+    EXPECT_EQ(stats.internal_path_length, 16);
+    EXPECT_EQ(stats.external_path_length, tree.get_external_path_length());
+
+    std::vector<size_t> depths = { 1, 2, 4, 2 };
+    EXPECT_EQ(stats.depth_histogram, depths);
+    // листья 1, 4, 7, 9 и корень 5 сбалансированы, у 2, 3, 6, 8 высоты поддеревьев отличаются на 1
+    std::vector<size_t> imbalance = { 5, 4 };
+    EXPECT_EQ(stats.imbalance_histogram, imbalance);
+
+    EXPECT_DOUBLE_EQ(stats.average_search_depth, 16.0 / 9 + 1);
+    EXPECT_DOUBLE_EQ(stats.miss_search_depth, 34.0 / 10);
+    EXPECT_DOUBLE_EQ(stats.optimal_search_depth, 25.0 / 9);
+}
+
+TEST (BST, rebalance_test) {
+    const int count = 1000;
+    BST<int, int> tree;
+    for (int key = 1; key <= count; ++key) {
+        tree.insert(key, key * 2);
+    }
+
+    Tree_stats before = tree.analyze();
+    EXPECT_EQ(before.height, count);
+    EXPECT_GT(before.degeneration, 10);
+
+    tree.rebalance();
+
+    Tree_stats after = tree.analyze();
+    EXPECT_EQ(after.nodes, count);
+    EXPECT_EQ(after.height, 10);
+    EXPECT_DOUBLE_EQ(after.degeneration, 1);
+    EXPECT_EQ(tree.get_size(), count);
+
+    std::vector<int> keys = tree.get_keys();
+    for (int key = 1; key <= count; ++key) {
+        EXPECT_EQ(keys[key - 1], key);
+        EXPECT_EQ(tree.at(key), key * 2);
+    }
+
+    BST<int, int> empty;
+    empty.rebalance();
+    EXPECT_TRUE(empty.is_empty());
+}
+
+TEST (BST, copy_constructor_test) {
+    BST<int, int> tree;
+    for (int key : { 5, 8, 3, 6, 7, 9, 4, 2, 1 }) {
+        tree.insert(key, key * 10);
+    }
+
+    BST<int, int> copy(tree);
+    EXPECT_EQ(copy.get_size(), tree.get_size());
+    EXPECT_EQ(copy.get_keys(), tree.get_keys());
+    EXPECT_EQ(copy.get_external_path_length(), tree.get_external_path_length());
+
+    copy.at(5) = 0;
+    EXPECT_EQ(tree.at(5), 50);
+}
+
+TEST (BST, scapegoat_sorted_inserts) {
+    const int count = 5000;
+    const double alpha = 0.7;
+    BST<int, int> tree;
+    tree.enable_scapegoat(alpha);
+
+    for (int key = 1; key <= count; ++key) {
+        EXPECT_TRUE(tree.insert(key, key));
+    }
+    EXPECT_FALSE(tree.insert(count, 0));
+
+    size_t bound = static_cast<size_t>(std::log(count) / std::log(1 / alpha)) + 1;
+    Tree_stats stats = tree.analyze();
+    EXPECT_EQ(stats.nodes, count);
+    EXPECT_LE(stats.height, bound);
+
+    std::vector<int> keys = tree.get_keys();
+    for (int key = 1; key <= count; ++key) {
+        EXPECT_EQ(keys[key - 1], key);
+    }
+}
+
+TEST (BST, scapegoat_random_churn) {
+    const double alpha = 0.6;
+    std::mt19937 random(99);
+    std::uniform_int_distribution<int> key_dist(0, 100000);
+
+    BST<int, int> tree;
+    tree.enable_scapegoat(alpha);
+    std::set<int> expected;
+
+    for (int i = 0; i < 20000; ++i) {
+        int key = key_dist(random);
+        if (i % 3 == 2) {
+            EXPECT_EQ(tree.remove(key), expected.erase(key) == 1);
+        } else {
+            EXPECT_EQ(tree.insert(key, key), expected.insert(key).second);
+        }
+
+        // убывающая последовательность сильнее всего разбалансирует обычное дерево
+        if (i % 5 == 0) {
+            int descending = 200000 - i;
+            EXPECT_EQ(tree.insert(descending, descending), expected.insert(descending).second);
+        }
+    }
+
+    Tree_stats stats = tree.analyze();
+    EXPECT_EQ(stats.nodes, expected.size());
+    // после удалений высота ограничена через наибольший размер, который не превосходит size / alpha
+    size_t bound = static_cast<size_t>(std::log(expected.size() / alpha) / std::log(1 / alpha)) + 1;
+    EXPECT_LE(stats.height, bound);
+    EXPECT_EQ(tree.get_keys(), std::vector<int>(expected.begin(), expected.end()));
+
+    EXPECT_THROW(tree.enable_scapegoat(0.4), Array_exception);
+}
+
+TEST (BST, scapegoat_insert_sorted) {
+    BST<int, int> tree;
+    tree.enable_scapegoat(0.75);
+
+    std::vector<std::pair<int, int>> batch;
+    for (int round = 0; round < 20; ++round) {
+        batch.clear();
+        for (int key = round * 100; key < round * 100 + 100; ++key) { // каждый пакет правее предыдущих
+            batch.emplace_back(key, key);
+        }
+        tree.insert_sorted(batch);
+    }
+
+    Tree_stats stats = tree.analyze();
+    EXPECT_EQ(stats.nodes, 2000);
+    EXPECT_LE(stats.height, static_cast<size_t>(std::log(2000) / std::log(1 / 0.75)) + 1);
+}
+
+TEST (BST, augmented_range_sum) {
+    std::mt19937 random(5);
+    std::uniform_int_distribution<int> key_dist(0, 2000);
+
+    BST<int, long long, Sum_augmentation<int, long long>> tree;
+    std::map<int, long long> expected;
+
+    auto check = [&tree, &expected, &random, &key_dist]() {
+        for (int query = 0; query < 20; ++query) {
+            int lo = key_dist(random);
+            int hi = key_dist(random);
+            long long sum = 0;
+            for (auto it = expected.lower_bound(lo); it != expected.end() && it->first <= hi; ++it) {
+                sum += it->second;
+            }
+            EXPECT_EQ(tree.aggregate(lo, hi), sum);
+        }
+    };
+
+    for (int i = 0; i < 3000; ++i) {
+        int key = key_dist(random);
+        switch (i % 4) {
+        case 0:
+        case 1:
+            EXPECT_EQ(tree.insert(key, key * 3), expected.emplace(key, key * 3).second);
+            break;
+        case 2:
+            EXPECT_EQ(tree.remove(key), expected.erase(key) == 1);
+            break;
+        default:
+            if (expected.count(key) == 1) {
+                expected[key] = -key;
+            }
+            EXPECT_EQ(tree.update(key, -key), expected.count(key) == 1);
+        }
+
+        if (i % 500 == 0) {
+            check();
+        }
+        if (i == 1500) {
+            tree.enable_scapegoat(0.7); // перестройки и повороты должны сохранять агрегаты
+        }
+    }
+
+    check();
+    tree.rebalance();
+    check();
+
+    std::vector<std::pair<int, long long>> batch = { { 5000, 1 }, { 5001, 2 }, { 5002, 3 } };
+    tree.insert_sorted(batch);
+    EXPECT_EQ(tree.aggregate(5000, 6000), 6);
+
+    BST<int, long long, Sum_augmentation<int, long long>> copy(tree);
+    EXPECT_EQ(copy.get_summary(), tree.get_summary());
+    EXPECT_EQ(tree.aggregate(10, 5), 0);
+}
+
+// Конкатенация не коммутативна: агрегат должен складываться строго по возрастанию ключей
+struct Concat_augmentation {
+    using value_type = std::string;
+
+    static value_type identity() { return std::string(); }
+    static value_type lift(const int&, const char& data) { return std::string(1, data); }
+    static value_type combine(const value_type& a, const value_type& b) { return a + b; }
+};
+
+TEST (BST, augmented_order_sensitive) {
+    BST<int, char, Concat_augmentation> tree;
+    std::string letters = "qwertyuiopasdfghjklzxcvbnm";
+    for (size_t i = 0; i < letters.size(); ++i) {
+        int key = static_cast<int>(letters[i]);
+        tree.insert(key, letters[i]);
+    }
+
+    EXPECT_EQ(tree.get_summary(), "abcdefghijklmnopqrstuvwxyz");
+    EXPECT_EQ(tree.aggregate('c', 'h'), "cdefgh");
+
+    tree.remove('e');
+    tree.remove('q');
+    EXPECT_EQ(tree.aggregate('a', 'r'), "abcdfghijklmnopr");
+}
+
+TEST (BST, augmented_min_max) {
+    BST<int, int, Min_max_augmentation<int, int>> tree;
+    for (int key = 0; key < 100; ++key) {
+        tree.insert(key, (key * 37) % 101);
+    }
+
+    auto summary = tree.aggregate(10, 19);
+    int min = 1000;
+    int max = -1;
+    for (int key = 10; key <= 19; ++key) {
+        min = std::min(min, (key * 37) % 101);
+        max = std::max(max, (key * 37) % 101);
+    }
+    EXPECT_EQ(summary.count, 10);
+    EXPECT_EQ(summary.min, min);
+    EXPECT_EQ(summary.max, max);
+    EXPECT_EQ(tree.aggregate(200, 300).count, 0);
+}
+
+TEST (BST, interval_overlap) {
+    std::mt19937 random(17);
+    std::uniform_int_distribution<int> start_dist(0, 10000);
+    std::uniform_int_distribution<int> length_dist(0, 300);
+
+    BST<int, int, Interval_augmentation<int>> tree; // начало -> конец отрезка
+    std::map<int, int> intervals;
+    for (int i = 0; i < 2000; ++i) {
+        int start = start_dist(random);
+        int end = start + length_dist(random);
+        tree.insert(start, end);
+        intervals.emplace(start, end);
+    }
+
+    for (int query = 0; query < 100; ++query) {
+        int from = start_dist(random);
+        int to = from + length_dist(random) / 10;
+
+        std::vector<int> expected;
+        for (const auto& [start, end] : intervals) {
+            if (start <= to && end >= from) {
+                expected.push_back(start);
+            }
+        }
+
+        std::vector<int> found;
+        tree.visit_where(Interval_augmentation<int>::overlapping(from, to),
+                         [&found](const int& start, const int&) { found.push_back(start); });
+        EXPECT_EQ(found, expected);
+    }
+}
+
+TEST (BST, compact_preserves_tree) {
+    for (Compact_layout layout : { Compact_layout::breadth_first, Compact_layout::in_order }) {
+        std::mt19937 random(41);
+        std::uniform_int_distribution<int> key_dist(0, 50000);
+
+        BST<int, int> tree;
+        tree.enable_cache(64);
+        for (int i = 0; i < 20000; ++i) { // старение: вставки вперемешку с удалениями
+            int key = key_dist(random);
+            if (i % 3 == 2) {
+                tree.remove(key);
+            } else {
+                tree.insert(key, key * 2);
+            }
+        }
+        std::vector<int> keys = tree.get_keys();
+        tree.at(keys[10]); // узел попадает в кэш
+
+        std::ostringstream before;
+        tree.dump(before);
+        size_t memory_before = tree.get_node_memory();
+
+        tree.compact(layout);
+
+        std::ostringstream after;
+        tree.dump(after);
+        EXPECT_EQ(before.str(), after.str()); // форма, ключи и данные не изменились
+        EXPECT_LE(tree.get_node_memory(), memory_before);
+        EXPECT_EQ(tree.at(keys[10]), keys[10] * 2);
+
+        // после уплотнения дерево остаётся изменяемым
+        EXPECT_TRUE(tree.remove(keys[0]));
+        EXPECT_TRUE(tree.insert(-5, -10));
+        EXPECT_EQ(tree.at(-5), -10);
+        EXPECT_EQ(tree.get_size(), keys.size());
+    }
+}
+
+TEST (BST, compact_step_with_mutations) {
+    std::mt19937 random(8);
+    std::uniform_int_distribution<int> key_dist(0, 30000);
+
+    BST<int, long long, Sum_augmentation<int, long long>> tree;
+    std::set<int> expected;
+    for (int i = 0; i < 10000; ++i) {
+        int key = key_dist(random);
+        tree.insert(key, key);
+        expected.insert(key);
+    }
+
+    size_t steps = 0;
+    bool done = false;
+    while (!done) {
+        done = tree.compact_step(100);
+        ++steps;
+
+        for (int i = 0; i < 20; ++i) { // изменения между шагами
+            int key = key_dist(random);
+            if (i % 2 == 0) {
+                EXPECT_EQ(tree.insert(key, key), expected.insert(key).second);
+            } else {
+                EXPECT_EQ(tree.remove(key), expected.erase(key) == 1);
+            }
+        }
+    }
+
+    EXPECT_GT(steps, 50);
+    EXPECT_EQ(tree.get_keys(), std::vector<int>(expected.begin(), expected.end()));
+
+    long long sum = 0;
+    for (int key : expected) {
+        sum += key;
+    }
+    EXPECT_EQ(tree.get_summary(), sum);
+
+    tree.clear();
+    EXPECT_TRUE(tree.compact_step(10));
+    EXPECT_EQ(tree.get_node_memory(), 0);
+}
+
+TEST (BST, hash_diff) {
+    using Hash_tree = BST<int, int, Hash_augmentation<int, int>>;
+    std::mt19937 random(11);
+    std::uniform_int_distribution<int> key_dist(0, 50000);
+
+    Hash_tree primary;
+    for (int i = 0; i < 20000; ++i) {
+        int key = key_dist(random);
+        primary.insert(key, key);
+    }
+
+    Hash_tree same_shape(primary);
+    Hash_tree other_shape;
+    std::vector<std::pair<int, int>> items;
+    for (int key : primary.get_keys()) {
+        items.emplace_back(key, key);
+    }
+    other_shape.insert_sorted(items); // идеально сбалансированное дерево другой формы
+    EXPECT_TRUE(primary.diff(same_shape).empty());
+    EXPECT_TRUE(primary.diff(other_shape).empty());
+    EXPECT_EQ(primary.get_summary(), other_shape.get_summary());
+
+    std::set<int> changed;
+    for (int i = 0; i < 30; ++i) {
+        int key = key_dist(random);
+        if (primary.contains(key) && i % 3 == 0) {
+            primary.remove(key);
+        } else if (primary.contains(key)) {
+            primary.update(key, -key);
+        } else {
+            primary.insert(key, key);
+        }
+        changed.insert(key);
+    }
+
+    std::vector<int> expected(changed.begin(), changed.end());
+    EXPECT_EQ(primary.diff(same_shape), expected);
+    EXPECT_EQ(primary.diff(other_shape), expected);
+    EXPECT_EQ(same_shape.diff(primary), expected);
+
+    // сравнение только читает другое дерево: кэш и счётчики фильтра не меняются
+    other_shape.enable_cache(64);
+    other_shape.enable_filter(other_shape.get_size());
+    EXPECT_EQ(primary.diff(other_shape), expected);
+    EXPECT_EQ(other_shape.get_cache_hits() + other_shape.get_cache_misses(), 0);
+    EXPECT_EQ(other_shape.get_filter_stats().rejects + other_shape.get_filter_stats().false_positives, 0);
+
+    Hash_tree empty;
+    EXPECT_EQ(empty.diff(primary), primary.get_keys());
+    EXPECT_EQ(primary.diff(empty), primary.get_keys());
+}
+
+TEST (BST, delta_replication) {
+    using Hash_tree = BST<int, double, Hash_augmentation<int, double>>;
+    Hash_tree primary;
+    for (int key = 0; key < 1000; ++key) {
+        primary.insert(key * 7 % 1000, key * 0.5);
+    }
+    Hash_tree replica(primary);
+
+    primary.remove(10);
+    primary.remove(999);
+    primary.update(500, -1.0);
+    primary.insert(2000, 2.0);
+
+    std::stringstream delta;
+    EXPECT_EQ(primary.write_delta(replica, delta), 4);
+    std::string bytes = delta.str();
+
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 1));
+    EXPECT_THROW(replica.apply_delta(truncated), Array_exception);
+    EXPECT_EQ(replica.get_size(), 1000); // обрезанные изменения не применяются
+
+    Hash_tree stranger;
+    std::stringstream copy(bytes);
+    EXPECT_THROW(stranger.apply_delta(copy), Array_exception);
+
+    EXPECT_EQ(replica.apply_delta(delta), 4);
+    EXPECT_TRUE(primary.diff(replica).empty());
+    EXPECT_EQ(replica.get_keys(), primary.get_keys());
+    EXPECT_EQ(replica.at(500), -1.0);
+
+    std::stringstream garbage("not a delta at all, definitely not");
+    EXPECT_THROW(replica.apply_delta(garbage), Array_exception);
+}
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
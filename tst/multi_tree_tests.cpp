@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "../multi_tree.h"
+
+TEST (Multi_BST, insert_and_count) {
+    Multi_BST<int, int> tree;
+    EXPECT_TRUE(tree.is_empty());
+    EXPECT_EQ(tree.count(1), 0);
+
+    tree.insert(5, 50);
+    tree.insert(3, 30);
+    tree.insert(5, 51);
+    tree.insert(5, 52);
+    tree.insert(8, 80);
+
+    EXPECT_EQ(tree.get_size(), 5);
+    EXPECT_EQ(tree.get_key_count(), 3);
+    EXPECT_EQ(tree.count(5), 3);
+    EXPECT_EQ(tree.count(3), 1);
+    EXPECT_EQ(tree.count(4), 0);
+}
+
+TEST (Multi_BST, equal_range_keeps_insertion_order) {
+    Multi_BST<int, std::string> tree;
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(i % 3, std::to_string(i));
+    }
+
+    auto range = tree.equal_range(1);
+    EXPECT_EQ(range.second - range.first, 33);
+    int expected = 1;
+    for (std::string* it = range.first; it != range.second; ++it) {
+        EXPECT_EQ(*it, std::to_string(expected));
+        expected += 3;
+    }
+
+    const Multi_BST<int, std::string>& ctree = tree;
+    auto empty = ctree.equal_range(7);
+    EXPECT_EQ(empty.first, empty.second);
+}
+
+TEST (Multi_BST, erase_returns_removed_count) {
+    Multi_BST<int, int> tree;
+    for (int key : { 5, 3, 9, 7, 8, 1, 4 }) {
+        tree.insert(key, key);
+        tree.insert(key, key * 10);
+    }
+    tree.insert(5, 500);
+
+    EXPECT_EQ(tree.erase(5), 3); // узел с двумя потомками
+    EXPECT_EQ(tree.erase(5), 0);
+    EXPECT_EQ(tree.erase(1), 2); // лист
+    EXPECT_EQ(tree.get_size(), 10);
+    EXPECT_EQ(tree.get_key_count(), 5);
+
+    std::vector<int> keys = tree.get_keys();
+    std::vector<int> expected = { 3, 4, 7, 8, 9 };
+    EXPECT_EQ(keys, expected);
+    EXPECT_EQ(tree.count(8), 2);
+    EXPECT_EQ(*tree.equal_range(8).first, 8);
+}
+
+TEST (Multi_BST, matches_std_multimap) {
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> key_dist(0, 300);
+    std::uniform_int_distribution<int> op_dist(0, 9);
+
+    Multi_BST<int, int> tree;
+    std::multimap<int, int> expected;
+
+    for (int i = 0; i < 20000; ++i) {
+        int key = key_dist(random);
+        if (op_dist(random) < 8) {
+            tree.insert(key, i);
+            expected.emplace(key, i);
+        } else {
+            EXPECT_EQ(tree.erase(key), expected.erase(key));
+        }
+    }
+
+    EXPECT_EQ(tree.get_size(), expected.size());
+    for (int key = 0; key <= 300; ++key) {
+        auto range = tree.equal_range(key);
+        auto expected_range = expected.equal_range(key);
+        ASSERT_EQ(static_cast<size_t>(range.second - range.first), expected.count(key));
+        for (int* it = range.first; it != range.second; ++it, ++expected_range.first) {
+            EXPECT_EQ(*it, expected_range.first->second);
+        }
+    }
+}
+
+TEST (Multi_BST, insert_value_of_same_key) {
+    Multi_BST<int, std::string> tree;
+    tree.insert(1, std::string(64, 'a'));
+
+    for (int i = 0; i < 8; ++i) { // каждая вставка при заполненном массиве перевыделяет узел
+        tree.insert(1, *tree.equal_range(1).first);
+    }
+
+    auto range = tree.equal_range(1);
+    ASSERT_EQ(range.second - range.first, 9);
+    for (std::string* it = range.first; it != range.second; ++it) {
+        EXPECT_EQ(*it, std::string(64, 'a'));
+    }
+}
+
+namespace {
+
+struct Throwing_copy {
+    static int copies_left;
+    int value;
+
+    explicit Throwing_copy(int v) : value(v) {}
+    Throwing_copy(const Throwing_copy& other) : value(other.value) {
+        if (copies_left-- == 0) {
+            throw std::runtime_error("copy failed");
+        }
+    }
+};
+
+int Throwing_copy::copies_left = -1;
+
+}
+
+TEST (Multi_BST, insert_is_strongly_exception_safe) {
+    Multi_BST<int, Throwing_copy> tree;
+    Throwing_copy value(0);
+    for (int i = 0; i < 4; ++i) {
+        value.value = i;
+        tree.insert(1, value);
+    }
+
+    for (int fail_at = 0; fail_at < 5; ++fail_at) { // вставка пятого значения копирует 1 + 4 значения
+        Throwing_copy::copies_left = fail_at;
+        value.value = 99;
+        EXPECT_THROW(tree.insert(1, value), std::runtime_error);
+
+        EXPECT_EQ(tree.get_size(), 4);
+        auto range = tree.equal_range(1);
+        ASSERT_EQ(range.second - range.first, 4);
+        for (int i = 0; i < 4; ++i) {
+            EXPECT_EQ(range.first[i].value, i);
+        }
+    }
+
+    Throwing_copy::copies_left = 0;
+    EXPECT_THROW(tree.insert(2, value), std::runtime_error);
+    EXPECT_EQ(tree.get_key_count(), 1);
+    EXPECT_EQ(tree.count(2), 0);
+
+    Throwing_copy::copies_left = -1;
+    tree.insert(1, value);
+    EXPECT_EQ(tree.count(1), 5);
+}
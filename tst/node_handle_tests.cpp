@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+
+#include "../tree.h"
+#include "../array_exception.h"
+#include "../src/alloc_counter.h"
+
+TEST (BST_node_handle, extract_and_insert) {
+    BST<int, int> tree;
+    for (int key : { 50, 30, 70, 20, 40, 60, 80, 65 }) {
+        tree.insert(key, key * 10);
+    }
+
+    // у 50 два потомка: на его место перевязывается приемник 60, а не копируются его данные
+    int* successor_data = &tree.at(60);
+    BST<int, int>::Node_handle handle = tree.extract(50);
+    ASSERT_FALSE(handle.empty());
+    EXPECT_EQ(handle.key(), 50);
+    EXPECT_EQ(handle.data(), 500);
+    EXPECT_EQ(&tree.at(60), successor_data);
+    EXPECT_EQ(tree.get_size(), 7);
+    EXPECT_FALSE(tree.contains(50));
+    EXPECT_EQ(tree.get_keys(), std::vector<int>({ 20, 30, 40, 60, 65, 70, 80 }));
+
+    EXPECT_TRUE(tree.extract(51).empty());
+
+    handle.key() = 60; // ключ уже есть: узел остаётся в handle
+    EXPECT_FALSE(tree.insert(std::move(handle)));
+    ASSERT_FALSE(handle.empty());
+
+    handle.key() = 55;
+    EXPECT_TRUE(tree.insert(std::move(handle)));
+    EXPECT_TRUE(handle.empty());
+    EXPECT_EQ(tree.at(55), 500);
+    EXPECT_EQ(tree.get_keys(), std::vector<int>({ 20, 30, 40, 55, 60, 65, 70, 80 }));
+
+    BST<int, int>::Node_handle empty;
+    EXPECT_FALSE(tree.insert(std::move(empty)));
+    EXPECT_THROW(empty.key(), Array_exception);
+
+    {
+        BST<int, int>::Node_handle dropped = tree.extract(20); // узел освобождается деструктором
+    }
+    EXPECT_EQ(tree.get_size(), 7);
+}
+
+TEST (BST_node_handle, zero_allocation_moves) {
+    BST<int, int> left;
+    BST<int, int> right;
+    right.share_node_arena(left);
+
+    std::mt19937 random(12);
+    std::uniform_int_distribution<int> key_dist(0, 1000000);
+    std::set<int> all;
+    for (int i = 0; i < 20000; ++i) {
+        int key = key_dist(random);
+        if (all.insert(key).second) {
+            (i % 2 == 0 ? left : right).insert(key, key);
+        }
+    }
+    std::vector<int> left_keys = left.get_keys();
+    std::vector<int> right_keys = right.get_keys();
+
+    size_t before = get_alloc_stats().allocations;
+
+    // перебалансировка очередей: наименьшие ключи одного дерева уходят в другое и обратно
+    size_t moved = 0;
+    for (int key : left_keys) {
+        moved += right.insert(left.extract(key)) ? 1 : 0;
+    }
+    for (int key : right_keys) {
+        moved += right.splice(left, key) ? 1 : 0; // уже в right: ничего не происходит
+        moved += left.splice(right, key) ? 1 : 0;
+    }
+    size_t merged = left.merge(right);
+
+    size_t allocations = get_alloc_stats().allocations - before;
+    EXPECT_EQ(allocations, 0);
+    EXPECT_EQ(moved, left_keys.size() + right_keys.size());
+    EXPECT_EQ(merged, left_keys.size());
+    EXPECT_TRUE(right.is_empty());
+    EXPECT_EQ(left.get_keys(), std::vector<int>(all.begin(), all.end()));
+}
+
+TEST (BST_node_handle, merge_keeps_duplicates_in_source) {
+    BST<int, long long, Sum_augmentation<int, long long>> target;
+    BST<int, long long, Sum_augmentation<int, long long>> source;
+    source.share_node_arena(target);
+    target.enable_cache(64);
+    source.enable_cache(64);
+
+    for (int key = 0; key < 1000; key += 2) {
+        target.insert(key, 1);
+    }
+    for (int key = 0; key < 1000; key += 3) {
+        source.insert(key, 10);
+        source.at(key); // кэш источника указывает на узлы, которые уйдут
+    }
+
+    size_t moved = source.get_size() - 167; // ключи, кратные 6, уже есть в target
+    EXPECT_EQ(target.merge(source), moved);
+    EXPECT_EQ(source.get_size(), 167);
+    EXPECT_EQ(target.get_size(), 500 + moved);
+
+    for (int key : source.get_keys()) {
+        EXPECT_EQ(key % 6, 0);
+        EXPECT_EQ(source.at(key), 10);
+        EXPECT_EQ(target.at(key), 1);
+    }
+    EXPECT_THROW(source.at(3), Array_exception);
+    EXPECT_EQ(target.at(3), 10);
+
+    EXPECT_EQ(target.get_summary(), 500 + 10 * static_cast<long long>(moved));
+    EXPECT_EQ(source.get_summary(), 10 * 167);
+    EXPECT_LE(target.analyze().height, 11);
+}
+
+TEST (BST_node_handle, merge_with_filter_and_cache) {
+    BST<int, int> target;
+    BST<int, int> source;
+    target.enable_filter(64); // слияние переполняет фильтр и вызывает его перестройку
+    target.enable_cache(16);
+    source.enable_filter(1000);
+    source.enable_cache(16);
+
+    for (int key = 0; key < 10; ++key) {
+        target.insert(key, -key);
+        target.at(key);
+    }
+    for (int key = 5; key < 505; ++key) {
+        source.insert(key, key);
+        source.at(key);
+    }
+
+    EXPECT_EQ(target.merge(source), 495);
+    EXPECT_EQ(target.get_size(), 505);
+    EXPECT_EQ(source.get_size(), 5);
+
+    for (int key = 0; key < 505; ++key) {
+        ASSERT_TRUE(target.contains(key));
+        EXPECT_EQ(target.at(key), key < 10 ? -key : key);
+        EXPECT_EQ(source.contains(key), key >= 5 && key < 10);
+    }
+    for (int key = 5; key < 10; ++key) {
+        EXPECT_EQ(source.at(key), key);
+    }
+    EXPECT_FALSE(target.contains(505));
+    EXPECT_GE(target.get_filter_stats().capacity, 505);
+}
+
+TEST (BST_node_handle, no_op_merge_and_splice_leave_trees_alone) {
+    BST<int, int> target;
+    BST<int, int> source;
+    for (int key = 0; key < 100; ++key) { // цепочка: перестройка изменила бы высоту
+        target.insert(key, key);
+    }
+    for (int key = 10; key < 20; ++key) {
+        source.insert(key, -key);
+    }
+    target.enable_cache(16);
+    target.enable_filter(100);
+
+    EXPECT_EQ(target.merge(source), 0);
+    EXPECT_EQ(target.analyze().height, 100);
+    EXPECT_EQ(source.get_size(), 10);
+    EXPECT_EQ(source.at(15), -15);
+
+    EXPECT_FALSE(target.splice(source, 12));
+    EXPECT_EQ(target.get_cache_hits() + target.get_cache_misses(), 0);
+    Filter_stats stats = target.get_filter_stats();
+    EXPECT_EQ(stats.rejects + stats.false_positives, 0);
+}
+
+TEST (BST_node_handle, separate_arenas_and_compaction) {
+    BST<int, int> first;
+    BST<int, int> second;
+    for (int key = 0; key < 2000; ++key) {
+        first.insert((key * 7919) % 2000, key);
+    }
+
+    // разные распределители: узел переносится копированием, но результат тот же
+    EXPECT_TRUE(second.insert(first.extract(5)));
+    EXPECT_TRUE(second.splice(first, 6));
+    EXPECT_EQ(second.merge(first), 1998);
+    EXPECT_TRUE(first.is_empty());
+    EXPECT_EQ(second.get_size(), 2000);
+
+    // извлечённый узел держит блоки распределителя: уплотнять их нельзя
+    BST<int, int>::Node_handle handle = second.extract(100);
+    EXPECT_THROW(second.compact(), Array_exception);
+    EXPECT_TRUE(second.insert(std::move(handle)));
+    second.compact();
+
+    // узел, извлечённый посреди пошагового уплотнения, переносится в новое поколение заранее
+    EXPECT_FALSE(second.compact_step(100));
+    int data = second.at(1999);
+    handle = second.extract(1999);
+    while (!second.compact_step(100)) {
+    }
+    EXPECT_EQ(handle.data(), data);
+    EXPECT_TRUE(second.insert(std::move(handle)));
+    EXPECT_EQ(second.get_size(), 2000);
+
+    BST<int, int> shared;
+    shared.share_node_arena(second);
+    EXPECT_THROW(second.compact(), Array_exception);
+    EXPECT_THROW(second.share_node_arena(shared), Array_exception);
+}
+
+TEST (BST_node_handle, share_arena_after_emptied_compaction) {
+    BST<int, int> donor;
+    for (int key = 0; key < 500; ++key) {
+        donor.insert(key, key);
+    }
+
+    // дерево опустело посреди уплотнения: извлечённый узел уже перенесён в новое поколение
+    EXPECT_FALSE(donor.compact_step(10));
+    BST<int, int>::Node_handle handle = donor.extract(250);
+    for (int key = 0; key < 500; ++key) {
+        donor.remove(key);
+    }
+    ASSERT_TRUE(donor.is_empty());
+
+    BST<int, int> owner;
+    for (int key = 1000; key < 1100; ++key) {
+        owner.insert(key, key);
+    }
+    donor.share_node_arena(owner);
+
+    // прерванное уплотнение не продолжается на чужом распределителе
+    EXPECT_EQ(handle.data(), 250);
+    EXPECT_TRUE(donor.insert(std::move(handle)));
+    EXPECT_THROW(donor.compact_step(10), Array_exception);
+    EXPECT_EQ(donor.at(250), 250);
+    for (int key = 1000; key < 1100; ++key) {
+        EXPECT_EQ(owner.at(key), key);
+    }
+    EXPECT_THROW(owner.compact(), Array_exception);
+}
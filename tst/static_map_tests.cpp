@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string_view>
+
+#include "../static_map.h"
+#include "../array_exception.h"
+
+enum class Opcode { nop, load, store, add, jump, halt };
+
+constexpr auto opcodes = make_static_map<std::string_view, Opcode>({
+    { "store", Opcode::store },
+    { "add", Opcode::add },
+    { "nop", Opcode::nop },
+    { "halt", Opcode::halt },
+    { "load", Opcode::load },
+    { "jump", Opcode::jump },
+});
+
+// поиск вычисляется во время компиляции
+static_assert(opcodes.get_size() == 6);
+static_assert(opcodes.at("load") == Opcode::load);
+static_assert(opcodes["halt"] == Opcode::halt);
+static_assert(opcodes.contains("jump"));
+static_assert(!opcodes.contains("mul"));
+static_assert(!opcodes.contains("a") && !opcodes.contains("zzz")); // меньше и больше всех ключей
+static_assert(opcodes.find("mul") == nullptr);
+
+constexpr auto squares = [] {
+    std::pair<int, int> items[100];
+    for (int i = 0; i < 100; ++i) {
+        items[i] = { (i * 37) % 100, (i * 37) % 100 * ((i * 37) % 100) };
+    }
+    return make_static_map(items);
+}();
+
+static_assert(squares.at(0) == 0 && squares.at(99) == 9801 && squares.at(42) == 1764);
+static_assert(!squares.contains(-1) && !squares.contains(100));
+
+TEST (Static_map, matches_std_map) {
+    EXPECT_EQ(opcodes.get_keys(), std::vector<std::string_view>({ "add", "halt", "jump", "load", "nop", "store" }));
+    EXPECT_THROW(opcodes.at("mul"), Array_exception);
+
+    // все размеры от 1 до 64: неполный последний уровень в любом положении
+    std::mt19937 random(13);
+    std::uniform_int_distribution<int> key_dist(0, 200);
+    auto check = [&random, &key_dist]<size_t N>() {
+        std::map<int, int> expected;
+        std::pair<int, int> items[N];
+        for (size_t i = 0; i < N; ++i) {
+            int key;
+            do {
+                key = key_dist(random);
+            } while (expected.count(key) == 1);
+            expected[key] = -key;
+            items[i] = { key, -key };
+        }
+
+        Static_map<int, int, N> table(items);
+        std::vector<int> keys;
+        for (const auto& item : expected) {
+            keys.push_back(item.first);
+        }
+        EXPECT_EQ(table.get_keys(), keys);
+
+        for (int key = -1; key <= 201; ++key) {
+            EXPECT_EQ(table.contains(key), expected.count(key) == 1);
+            if (expected.count(key) == 1) {
+                EXPECT_EQ(table.at(key), -key);
+            }
+        }
+    };
+
+    [&check]<size_t... I>(std::index_sequence<I...>) {
+        (check.template operator()<I + 1>(), ...);
+    }(std::make_index_sequence<64>());
+}
+
+TEST (Static_map, duplicate_keys) {
+    std::pair<int, int> items[] = { { 1, 1 }, { 2, 2 }, { 1, 3 } };
+    EXPECT_THROW(make_static_map(items), Array_exception);
+}